@@ -0,0 +1,87 @@
+// avl.h
+//
+// Interface definition for the ordered block index (AVL tree).
+//
+// The tree does not own anything: each entry points at a list node that lives
+// in some list_t, and the ordering is derived from the node's block through a
+// key function. Blocks with equal keys are ordered by their start address or,
+// in a size index, by when they were inserted, so every free block has a
+// unique position in the index.
+#ifndef AVL_H
+#define AVL_H
+
+#include "list.h"
+#include "pool.h"
+
+/* Returns the primary ordering key of a block. */
+typedef int (*avl_key_fn)(const block_t *blk);
+
+/* How blocks with equal keys are ordered. The insertion orders match the
+ * unindexed free lists: best fit inserts a block before those of its size
+ * and worst fit after them. A stamped tree keeps each block's insertion
+ * stamp in its tag. The one difference left is worst fit after a coalesce:
+ * the unindexed list is then in address order, and a block inserted into it
+ * stops at the first smaller block, which can be ahead of its equals. */
+typedef enum avl_tie {
+  AVL_TIE_START,         // ascending start address
+  AVL_TIE_OLDEST_FIRST,  // in insertion order
+  AVL_TIE_NEWEST_FIRST   // in reverse insertion order
+} avl_tie_t;
+
+typedef struct avl_node {
+  node_t *node;   // list node holding the indexed block
+  int key;        // cached key(node->blk)
+  int tie;        // cached start address or signed insertion stamp
+  int height;
+  struct avl_node *left;
+  struct avl_node *right;
+} avl_node_t;
+
+typedef struct avl_tree {
+  avl_node_t *root;
+  avl_key_fn key;
+  avl_tie_t order;
+  int stamp;      // last insertion stamp handed out
+  int count;
+} avl_tree_t;
+
+/* Key functions used by the memory manager. */
+int avl_key_size(const block_t *blk);       // ascending block size (best fit)
+int avl_key_size_desc(const block_t *blk);  // descending block size (worst fit)
+int avl_key_start(const block_t *blk);      // ascending start address
+
+avl_tree_t *avl_alloc(avl_key_fn key, avl_tie_t order);
+void avl_free(avl_tree_t *tree);
+
+/* Frees every tree and entry at once (see pool.h). */
+void avl_release_all();
+
+/* Adds the bytes held by trees and entries to stats. */
+void avl_mem_stats(mem_stats_t *stats);
+
+/* Adds or removes the entry for a node. A block must be removed before its
+ * start or end is modified and inserted again afterwards. Inserting into a
+ * stamped tree gives the block a new stamp. */
+void avl_insert(avl_tree_t *tree, node_t *node);
+void avl_remove(avl_tree_t *tree, node_t *node);
+
+/* Returns the node indexing a block with the same start and key, or NULL.
+ * An indexed block is found in O(log n); in a stamped tree, a copy of one
+ * is looked for among all the blocks of its key. */
+node_t *avl_find(avl_tree_t *tree, block_t *blk);
+
+/* Returns the first / last node in index order, or NULL if the tree is empty. */
+node_t *avl_first(avl_tree_t *tree);
+node_t *avl_last(avl_tree_t *tree);
+
+/* Returns the first node whose key is >= key, or NULL. */
+node_t *avl_lower_bound(avl_tree_t *tree, int key);
+
+/* Returns the last node whose key is <= key, or NULL. */
+node_t *avl_floor(avl_tree_t *tree, int key);
+
+/* Returns the first node ordered strictly after blk, or NULL. blk need not be
+ * in the tree; in a stamped tree it is placed as if it were inserted next. */
+node_t *avl_successor(avl_tree_t *tree, block_t *blk);
+
+#endif /* AVL_H */
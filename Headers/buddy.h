@@ -0,0 +1,38 @@
+// buddy.h
+//
+// Interface definition for the binary buddy allocation engine (policy 5).
+//
+// The engine works on the simulator's own lists. FREE_LIST holds the free
+// buddy blocks, every one a power of two in size and aligned to it, in
+// address order with a size and an address index. An ALLOC_LIST entry keeps
+// the requested extent [start, start + size - 1]; the rest of its buddy block,
+// up to the next power of two, is internal fragmentation and is reported
+// separately by buddy_stats.
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include "list.h"
+
+/* Internal fragmentation of the allocated blocks. */
+typedef struct buddy_stats {
+  int blocks;      // allocated buddy blocks
+  long requested;  // bytes asked for
+  long reserved;   // bytes held, requests rounded up to powers of two
+} buddy_stats_t;
+
+/* Splits the blocks already on freelist (normally the whole partition) into
+ * aligned power of two blocks and indexes the list for the engine. */
+void buddy_init(list_t *freelist);
+
+/* Allocates size bytes for pid from the smallest free block that can hold
+ * the rounded request, splitting it down to that order. Returns the block,
+ * or NULL if there is none. */
+block_t *buddy_allocate(list_t *freelist, list_t *alloclist, int pid, int size);
+
+/* Frees the allocated block at node and merges it with its buddy for as long as
+ * the buddy is free and of the same order. */
+void buddy_free(list_t *alloclist, list_t *freelist, node_t *node);
+
+void buddy_stats(list_t *alloclist, buddy_stats_t *stats);
+
+#endif /* BUDDY_H */
@@ -8,37 +8,68 @@
 
 #include <stdbool.h>
 
-typedef struct block {
-  int pid;   // Process ID
-	int start; // Start of the memory block
-  int end; // End of the memory block
-} block_t;
+typedef struct block block_t;
 
 /* Defines the node structure. Each node contains its element, and points to the
- * next node in the list. The last element in the list should have NULL as its
- * next pointer. */
+ * next and previous nodes in the list. The last element in the list should have
+ * NULL as its next pointer, the first element NULL as its prev pointer. */
 typedef struct node {
   block_t *blk;
 	struct node *next;
+  struct node *prev; // Back link so an indexed node can be unlinked in O(1)
 } node_t;
 
+/* The list is intrusive: every block carries the node that links it, so a
+ * list walk reads the links and the block from one record. A block can
+ * therefore be on at most one list at a time. */
+struct block {
+  int pid;   // Process ID
+	int start; // Start of the memory block
+  int end; // End of the memory block
+  int tag; // Engine header of an allocated block (TLSF, see tlsf.h), or a free block's
+           // insertion stamp in a size index (see avl.h); fills padding
+  node_t link; // List node embedded in the block, link.blk points back here
+};
+
+struct avl_tree;
+struct pid_map;
+struct soa_store;
+struct tlsf;
+struct quick_lists;
+
 /* Defines the list structure, which simply points to the first node in the
  * list. */
 struct list {
 	node_t *head;
   node_t *tail; // Tail pointer for efficient operations
   int length; // Length of the list for quick access
+  struct avl_tree *size_index; // Optional block size index (see avl.h), NULL if unused
+  struct avl_tree *addr_index; // Optional start address index, NULL if unused
+  struct pid_map *pid_index; // Optional PID hash index (see pidmap.h), NULL if unused
+  struct soa_store *soa; // Optional packed array backend (see soa.h); when set the list has no nodes
+  struct tlsf *tlsf; // Optional TLSF engine (see tlsf.h); when set the list has no nodes
+  struct quick_lists *quick; // Optional size class caches in front of the free list (see quick.h), NULL if unused
+  node_t *rover; // Next fit resume position, NULL to start at head; moves on when its node is unlinked
 };
 typedef struct list list_t;
 
 /* Functions for allocating and freeing lists. By using only these functions,
  * the user should be able to allocate and free all the memory required for
- * this linked list library. */
+ * this linked list library. Lists, nodes and blocks are drawn from pools (see
+ * pool.h), and list_release_all frees all of them in one bulk release. */
 list_t *list_alloc();
-node_t *node_alloc(block_t *blk);
+node_t *node_alloc(block_t *blk); // returns the node embedded in blk
+block_t *block_alloc();
 
 void list_free(list_t *l);
 void node_free(node_t *node);
+void block_free(block_t *blk);
+void list_release_all();
+
+/* Adds the metadata footprint of every list, block and index to stats (see
+ * pool.h). The peak is the sum of each allocator's high water mark. */
+struct mem_stats;
+void list_mem_stats(struct mem_stats *stats);
 
 /* Prints the list in some format. */
 void list_print(list_t *l);
@@ -50,10 +81,47 @@ int list_length(list_t *l);
 void list_add_to_back(list_t *l, block_t *blk);
 void list_add_to_front(list_t *l, block_t *blk);
 void list_add_at_index(list_t *l, block_t *blk, int index);
+void list_add_before(list_t *l, block_t *blk, node_t *next); // next == NULL adds to back
 void list_add_ascending_by_address(list_t *l, block_t *blk);
 void list_add_ascending_by_blocksize(list_t *l, block_t *blk);
 void list_add_descending_by_blocksize(list_t *l, block_t *blk);
 void list_add_to_freelist (list_t *freelist, block_t *block, int policy);
+void list_add_by_index(list_t *l, block_t *blk);
+
+/* Keeps the list ordered by a block size index for policy 2 (ascending) or
+ * policy 3 (descending). Equal sizes are ordered as in the unindexed list
+ * (see avl_tie_t). Once
+ * indexed, list_add_to_freelist and remove_block_from_freelist run in
+ * O(log n). Policy 5 (buddy) indexes ascending sizes, lowest address first.
+ * Other policies leave the list unindexed. */
+void list_index_by_size(list_t *l, int policy);
+
+/* Attaches a start address index to the list so the physical neighbours of a
+ * block can be found in O(log n). A free list with an address index is
+ * coalesced eagerly by deallocate_memory. */
+void list_index_by_address(list_t *l);
+
+/* Attaches a PID hash index to an address ordered list (the allocated list),
+ * so list_is_in_by_pid and list_get_node_by_pid run in O(1). */
+void list_index_by_pid(list_t *l);
+
+/* Moves a free list's blocks into a structure-of-arrays store (see soa.h)
+ * whose kernels use the given soa_isa_t. From then on the list has no nodes:
+ * list_add_to_freelist, remove_block_from_freelist, allocate_memory,
+ * coalese_memory and print_list work on the store, and length stays in sync. */
+void list_use_soa(list_t *l, int isa);
+
+/* Hands a free list's blocks to a TLSF engine (see tlsf.h). As with
+ * list_use_soa the list has no nodes afterwards; allocate_memory and
+ * deallocate_memory go through the engine, which merges freed blocks
+ * immediately, and an allocated block's tag is its engine header. */
+void list_use_tlsf(list_t *l);
+
+/* Puts size class quick lists (see quick.h) in front of a free list managed
+ * with policy. list_flush_quick returns the cached blocks to the list; it is
+ * called by coalese_memory. */
+void list_use_quick(list_t *l, int policy);
+void list_flush_quick(list_t *l);
 
 /* Methods for removing from the list. Returns the removed element. */
 block_t* list_remove_from_back(list_t *l);
@@ -61,6 +129,9 @@ block_t* list_remove_from_front(list_t *l);
 block_t* list_remove_at_index(list_t *l, int index);
 void remove_block_from_freelist(list_t *freelist, block_t *block);
 
+/* Unlinks node from the list. Its block is kept. */
+void list_remove_node(list_t *l, node_t *node);
+
 /* Checks to see if block of Size exists in the list. */
 bool list_is_in(list_t *l, block_t *blk);
 
@@ -82,6 +153,18 @@ int list_get_index_of_by_Size(list_t *l, int Size);
 /* Returns the index at which the pid appears. */
 int list_get_index_of_by_Pid(list_t *l, int pid);
 
+/* Returns the first node holding pid, or NULL. */
+node_t* list_get_node_by_pid(list_t *l, int pid);
+
+/* Returns the node of the block held by pid that starts at start, or NULL.
+ * With a PID index only that PID's blocks are searched, in O(log k). */
+node_t* list_get_node_by_pid_at(list_t *l, int pid, int start);
+
+/* Returns the node of the first block of an address ordered list that ends at
+ * or after addr, or NULL. It holds addr if it starts at or before it. With an
+ * address index this is O(log n). */
+node_t* list_get_node_by_address(list_t *l, int addr);
+
 /*return element in front or NULL if empty */
 block_t* list_get_from_front(list_t *l);
 
@@ -2,12 +2,97 @@
 #define MAIN_H
 
 #include "list.h"  // Include the header for list-related definitions
+#include "util.h"  // trace_reader_t
+
+/* What the replay loop prints after each operation. */
+typedef enum output_mode {
+  OUTPUT_FULL,     // both lists after every operation (default)
+  OUTPUT_QUIET,    // nothing
+  OUTPUT_EVERY,    // both lists after every output_every-th operation
+  OUTPUT_FINAL,    // both lists once, after the last operation
+  OUTPUT_SUMMARY   // one line per operation: free bytes, holes, largest hole
+} output_mode_t;
+
+/* Optional behaviours selected by the flags that follow the policy argument.
+ * All of them are off by default. */
+typedef struct mmu_options {
+  bool indexed;         // -I: keep FREE_LIST in a block size index
+  bool eager_coalesce;  // -E: merge free neighbours on every deallocation
+  bool soa;             // -S: keep FREE_LIST in packed arrays
+  int soa_isa;          // widest soa_isa_t the -S kernels may use
+  bool quick;           // -K: size class quick lists in front of FREE_LIST
+  bool compact;         // -C: the coalesce op also relocates allocated blocks
+  bool lazy;            // -L: coalesce and retry when an allocation fails
+  int lazy_length;      // -LAZY-LENGTH=N: also coalesce once FREE_LIST holds N blocks
+  int lazy_frag;        // -LAZY-FRAG=P: also coalesce once fragmentation reaches P%
+  int batch;            // -BATCH=N: allocate up to N consecutive allocate ops at once
+  bool relaxed;         // -RELAXED: batches may be served out of order
+  bool pid_free;        // -P: a free op releases every block of the PID
+  int page_size;        // -PAGE=N: page size of the paging engine (-G)
+  int levels;           // -LEVELS=N: its page table levels
+  int replace;          // replace_policy_t, -OVERCOMMIT=P; -1 to never evict
+  int tlb_entries;      // -TLB=N: TLB size, 0 for no TLB
+  int tlb_ways;         // -TLB-WAYS=N
+  int tlb_policy;       // tlb_policy_t, -TLB-POLICY=P
+  bool tlb_tags;        // -TLB-TAGS: PID tagged entries
+  output_mode_t output; // -Q, -EVERY=K, -FINAL, -SUMMARY
+  long output_every;    // K for OUTPUT_EVERY
+} mmu_options_t;
+
+/* One request of an allocate_memory_batch call. */
+typedef struct alloc_request {
+  int pid;
+  int size;
+  int start;   // set to the start of the block allocated, or -1 if none could hold it
+} alloc_request_t;
+
+/* Outcome of resize_memory. */
+typedef enum resize_result {
+  RESIZE_FAILED = -1,  // no block for the pid, or no room anywhere; the block is unchanged
+  RESIZE_IN_PLACE,     // grown into the free block after it, or shrunk
+  RESIZE_MOVED         // copied to a new block and the old one freed
+} resize_result_t;
+
+/* Answer to an address query. Memory that is not allocated is free, so the
+ * allocated list alone describes the whole partition. */
+typedef struct addr_owner {
+  int pid;     // owning PID, or 0 if free
+  int start;   // the allocated block, or the free range between allocated blocks
+  int end;
+} addr_owner_t;
+
+/* State of the lazy coalescing mode (-L). A threshold of 0 is off. */
+typedef struct lazy_coalesce {
+  int max_length;   // coalesce before an allocation once the free list has this many blocks
+  int max_frag;     // ... or once 1 - largest hole / free bytes reaches this percentage
+  bool dirty;       // blocks were freed since the last coalesce, so one can merge something
+  long coalesces;   // coalesces run by the mode
+  long rescued;     // allocations that only succeeded after a coalesce
+} lazy_coalesce_t;
+
+struct paging;
+struct tlb;
 
 // Function prototypes
-void get_input(char *args[], int input[][2], int *n, int *size, int *policy);
+void get_options(int argc, char *args[], mmu_options_t *opts);
+void get_input(char *args[], trace_reader_t **trace, int *size, int *policy);
 void allocate_memory(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy);
+int allocate_memory_batch(list_t *freelist, list_t *alloclist, alloc_request_t *reqs, int count,
+                          int policy, bool relaxed);
 void deallocate_memory(list_t *alloclist, list_t *freelist, int pid, int policy);
+int deallocate_all_memory(list_t *alloclist, list_t *freelist, int pid, int policy);
+bool deallocate_block(list_t *alloclist, list_t *freelist, int pid, int start, int policy);
+resize_result_t resize_memory(list_t *freelist, list_t *alloclist, int pid, int newsize, int policy);
+bool query_address(list_t *alloclist, int partition_size, int addr, addr_owner_t *owner);
+bool query_range(list_t *alloclist, int lo, int hi, addr_owner_t *owner);
+int translate_address(list_t *alloclist, struct paging *pager, struct tlb *tlb, int page_size,
+                      int pid, int vaddr, bool *hit);
 list_t* coalese_memory(list_t *list);
+long compact_memory(list_t *freelist, list_t *alloclist, int policy);
+list_t* allocate_memory_lazy(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy,
+                             lazy_coalesce_t *lazy);
 void print_list(list_t *list, char *message);
+void free_list_summary(list_t *list, int *free_bytes, int *holes, int *largest);
+void print_summary(list_t *freelist, long step);
 
 #endif // MAIN_H
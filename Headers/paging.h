@@ -0,0 +1,121 @@
+// paging.h
+//
+// Interface definition for the paging engine.
+//
+// An alternative to contiguous allocation: the partition is cut into frames of
+// page_size bytes, tracked by a bitmap, and every PID gets its own virtual
+// address space mapped by a multi-level page table. An allocation of size
+// bytes maps ceil(size / page_size) pages at the next virtual address of the
+// PID, each backed by any free frame, so there is no external fragmentation;
+// a free unmaps them again and gives page tables that became empty back.
+//
+// An engine can overcommit the partition (paging_use_replacement): once every
+// frame is taken, a replacement policy (see replace.h) picks a page to evict
+// to the backing store, and accessing an evicted page faults it back in.
+#ifndef PAGING_H
+#define PAGING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pool.h"
+#include "replace.h"
+
+#define PAGING_LEVEL_BITS 9                        // virtual page number bits per level
+#define PAGING_TABLE_ENTRIES (1 << PAGING_LEVEL_BITS)
+#define PAGING_MAX_LEVELS 4
+#define PAGING_SWAPPED -1                          // frame of a page in the backing store
+
+/* Page table entry. In the last level it maps a page to frame + 1, 0 if the
+ * page is unmapped and PAGING_SWAPPED if it was evicted; in the levels above
+ * it points at a next level table. */
+typedef union pte {
+  struct page_table *table;
+  int frame;
+} pte_t;
+
+typedef struct page_table {
+  int used;                           // entries in use; freed once it drops to 0
+  pte_t entry[PAGING_TABLE_ENTRIES];
+} page_table_t;
+
+/* One allocation: pages [vpn, vpn + pages) of its PID. */
+typedef struct paging_region {
+  long vpn;
+  int pages;
+  int size;     // bytes requested
+} paging_region_t;
+
+typedef struct paging_process {
+  int pid;                    // 0 marks an empty slot
+  page_table_t *root;         // level 0 table
+  long next_vpn;              // the next region is mapped here
+  paging_region_t *regions;   // ascending by vpn
+  int count, capacity;
+} paging_process_t;
+
+typedef struct frame_bitmap {
+  uint64_t *words;   // bit f set: frame f is in use
+  int frames;
+  int free;
+  int hint;          // word the next search starts from
+} frame_bitmap_t;
+
+typedef struct paging {
+  int page_size;
+  int levels;                          // 1 to PAGING_MAX_LEVELS
+  frame_bitmap_t frames;
+  paging_process_t *procs;             // open addressing hash map by PID
+  int proc_capacity, proc_used;
+  long tables[PAGING_MAX_LEVELS];      // live page tables per level, 0 is the root level
+  long peak_tables[PAGING_MAX_LEVELS];
+  long mapped_pages;
+  long requested;                      // bytes requested by the mapped regions
+  replacer_t *replacer;                // picks the pages to evict, NULL if not overcommitting
+  void (*on_evict)(void *arg, int pid, long vpn);  // told about every eviction, or NULL
+  void *evict_arg;
+  long accesses;                       // accesses to mapped pages, TLB hits included
+  long faults;                         // ... of which the page had been evicted
+  long evictions;
+  long swapped, peak_swapped;          // pages in the backing store
+} paging_t;
+
+/* Returns an engine for a partition of partition_size bytes, or exits on
+ * failure. page_size has to be at least 1 and levels 1 to PAGING_MAX_LEVELS. */
+paging_t *paging_alloc(int partition_size, int page_size, int levels);
+void paging_free(paging_t *pg);
+
+/* Lets the engine overcommit its frames, evicting pages with policy. */
+void paging_use_replacement(paging_t *pg, replace_policy_t policy);
+
+/* Adds the bytes held by live engines, page tables included, to stats. */
+void paging_mem_stats(mem_stats_t *stats);
+
+/* Maps size bytes for pid. Returns the virtual address of the region, or -1
+ * if there are not enough free frames (and no replacement policy) or virtual
+ * pages left. */
+long paging_map(paging_t *pg, int pid, int size);
+
+/* Unmaps the lowest region of pid. Returns false if pid has none. */
+bool paging_unmap(paging_t *pg, int pid);
+
+/* Unmaps every region of pid and returns how many there were. */
+int paging_unmap_all(paging_t *pg, int pid);
+
+/* Returns the frame holding virtual address vaddr of pid, or -1 if the
+ * address is not mapped or its page was evicted. */
+int paging_translate(paging_t *pg, int pid, long vaddr);
+
+/* paging_translate for an access to the address: the use is recorded with
+ * the replacement policy, and an evicted page is faulted back in first. */
+int paging_access(paging_t *pg, int pid, long vaddr);
+
+/* Records an access to resident page vpn of pid whose frame is already
+ * known, from a TLB hit: the replacement policy sees the use without a walk
+ * of the page table. */
+void paging_touch(paging_t *pg, int pid, long vpn);
+
+/* Prints the free frames, the mapped regions by PID and the page table
+ * memory per level. */
+void paging_print(paging_t *pg);
+
+#endif /* PAGING_H */
@@ -0,0 +1,56 @@
+// pidmap.h
+//
+// Interface definition for the PID index of the allocated list.
+//
+// An open addressing hash map (linear probing) from PID to the nodes of that
+// PID in an address ordered list. Only PIDs > 0 can be stored; 0 marks an
+// empty slot. The slot holds a PID's lowest addressed node, and the array
+// next to it the rest in ascending address order, so the PID's k blocks are
+// reached in O(k) and one of them by address in O(log k) without any links
+// in the blocks themselves. The array is used from an offset: a block above
+// the others is appended and the lowest is dropped from the front, both in
+// amortized O(1).
+#ifndef PIDMAP_H
+#define PIDMAP_H
+
+#include "list.h"
+#include "pool.h"
+
+typedef struct pid_slot {
+  int pid;       // 0 if the slot is empty
+  int count;     // number of blocks this PID holds in the list
+  int capacity;  // entries allocated for rest
+  int first;     // index in rest of the second lowest block
+  node_t *node;  // lowest addressed of those blocks
+  node_t **rest; // the other count - 1 from rest[first], ascending by address; NULL until needed
+} pid_slot_t;
+
+typedef struct pid_map {
+  pid_slot_t *slots;
+  int capacity;  // always a power of two
+  int used;
+  struct pid_map *prev, *next;  // chain of live maps for pid_map_release_all
+} pid_map_t;
+
+pid_map_t *pid_map_alloc();
+void pid_map_free(pid_map_t *map);
+
+/* Frees every live map. */
+void pid_map_release_all();
+
+/* Adds the bytes held by live maps to stats. */
+void pid_map_mem_stats(mem_stats_t *stats);
+
+/* Returns the first node held by pid, or NULL. */
+node_t *pid_map_get(pid_map_t *map, int pid);
+
+/* Returns the node held by pid whose block starts at start, or NULL. */
+node_t *pid_map_get_at(pid_map_t *map, int pid, int start);
+
+/* Keep the map in sync with the list. Adding a block above all of a PID's
+ * others and removing its lowest are amortized O(1); any other block costs
+ * a binary search and a move of the PID's higher blocks. */
+void pid_map_add(pid_map_t *map, node_t *node);
+void pid_map_remove(pid_map_t *map, node_t *node);
+
+#endif /* PIDMAP_H */
@@ -0,0 +1,50 @@
+// pool.h
+//
+// Interface definition for fixed size object pools.
+//
+// A pool hands out objects of one size carved from large slabs. Freed objects
+// are recycled through an intrusive free list, and all slabs can be given back
+// in one bulk release.
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+typedef struct pool_slab {
+  struct pool_slab *next;
+} pool_slab_t;
+
+typedef struct pool {
+  size_t obj_size;      // object size, rounded up to pointer alignment
+  size_t per_slab;      // objects carved from each slab
+  void *free_list;      // recycled objects, linked through their first word
+  char *bump;           // next never used object in the newest slab
+  char *bump_end;
+  pool_slab_t *slabs;
+  size_t in_use;        // objects currently handed out
+  size_t peak;          // high water mark of in_use
+  size_t reserved;      // bytes held in slabs
+} pool_t;
+
+/* Metadata footprint in bytes: currently allocated and high water mark. */
+typedef struct mem_stats {
+  size_t in_use;
+  size_t peak;
+} mem_stats_t;
+
+/* Static initializer, e.g. static pool_t nodes = POOL_INIT(sizeof(node_t)); */
+#define POOL_INIT(size) { (size), 0, NULL, NULL, NULL, NULL, 0, 0, 0 }
+
+void *pool_alloc(pool_t *pool);
+void pool_free(pool_t *pool, void *obj);
+
+/* Frees every slab at once. All objects from the pool become invalid. */
+void pool_release(pool_t *pool);
+
+/* Adds the bytes of the objects the pool has handed out to stats. */
+void pool_mem_stats(const pool_t *pool, mem_stats_t *stats);
+
+/* Records a change of delta bytes in a footprint that is not pool backed. */
+void mem_stats_track(mem_stats_t *stats, long delta);
+
+#endif /* POOL_H */
@@ -0,0 +1,55 @@
+// quick.h
+//
+// Interface definition for the size class quick lists.
+//
+// An optional front end for a free list: blocks of up to QUICK_MAX_SIZE bytes
+// that are freed go onto a stack for their exact size instead of back to the
+// free list, and a request of that size pops one in O(1). Cached blocks stay
+// free memory; they are only kept out of the free list until coalese_memory,
+// or an allocation the free list cannot serve without them, flushes them
+// back, so they never pin fragmentation past a coalesce or fail a request.
+#ifndef QUICK_H
+#define QUICK_H
+
+#include <stdbool.h>
+#include "list.h"
+#include "pool.h"
+
+#define QUICK_MAX_SIZE 256    // largest cached block size
+#define QUICK_CLASS_LIMIT 32  // blocks cached per size, the rest go to the free list
+
+typedef struct quick_class {
+  node_t *top;   // cached blocks chained through their own list nodes
+  int count;
+} quick_class_t;
+
+typedef struct quick_lists {
+  quick_class_t classes[QUICK_MAX_SIZE + 1];  // indexed by block size
+  int policy;    // free list policy flushed blocks are added with
+  int cached;    // blocks across all classes
+  long hits, misses, flushes;  // misses count only requests of a cached size
+  struct quick_lists *prev, *next;  // chain of live caches for quick_release_all
+} quick_lists_t;
+
+quick_lists_t *quick_alloc(int policy);
+
+/* Frees the caches and the blocks in them. */
+void quick_free(quick_lists_t *quick);
+
+/* Frees every live cache. The cached blocks go with the block pool. */
+void quick_release_all();
+
+/* Adds the bytes held by live caches to stats. */
+void quick_mem_stats(mem_stats_t *stats);
+
+/* Caches a free block. Returns false, leaving the block alone, if it is too
+ * large or its class is full. */
+bool quick_push(quick_lists_t *quick, block_t *blk);
+
+/* Returns a cached block of exactly size bytes, or NULL. */
+block_t *quick_pop(quick_lists_t *quick, int size);
+
+/* Empties the caches. Returns their blocks chained through node->next. */
+node_t *quick_take_all(quick_lists_t *quick);
+
+#endif /* QUICK_H */
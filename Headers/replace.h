@@ -0,0 +1,75 @@
+// replace.h
+//
+// Interface definition for the page replacement engines.
+//
+// Used by the paging engine when it overcommits (see paging.h): once every
+// frame holds a page, the policy picks the resident page that goes to the
+// backing store. Pages are identified by a key made of their PID and virtual
+// page number, and every policy does constant work per access:
+//  - LRU keeps the resident pages on a list in recency order, reached through
+//    a hash map from key to list node.
+//  - CLOCK keeps them on a circular list with a reference bit each; the hand
+//    clears set bits until it reaches a page whose bit is clear.
+//  - ARC keeps the pages used once (T1) apart from the ones used again (T2),
+//    remembers the keys of pages recently evicted from each (the ghost lists
+//    B1 and B2) and moves the target size of T1 towards the list whose ghosts
+//    are asked for again.
+#ifndef REPLACE_H
+#define REPLACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pool.h"
+
+#define REPLACE_VPN_BITS 36   // enough for PAGING_MAX_LEVELS levels
+#define REPLACE_KEY(pid, vpn) (((uint64_t)(pid) << REPLACE_VPN_BITS) | (uint64_t)(vpn))
+#define REPLACE_KEY_PID(key) ((int)((key) >> REPLACE_VPN_BITS))
+#define REPLACE_KEY_VPN(key) ((long)((key) & ((1ull << REPLACE_VPN_BITS) - 1)))
+
+typedef enum replace_policy {
+  REPLACE_LRU,
+  REPLACE_CLOCK,
+  REPLACE_ARC
+} replace_policy_t;
+
+/* Lists of the replacer. LRU and CLOCK only use REPLACE_T1. */
+enum { REPLACE_T1, REPLACE_T2, REPLACE_B1, REPLACE_B2, REPLACE_LISTS };
+
+typedef struct replace_node {
+  uint64_t key;
+  int prev, next;    // circular list links; unused nodes are chained through next
+  int list;
+  bool referenced;   // CLOCK reference bit
+} replace_node_t;
+
+typedef struct replacer {
+  replace_policy_t policy;
+  int capacity;              // frames, so resident pages at most
+  replace_node_t *nodes;     // nodes[0, REPLACE_LISTS) are the list heads
+  int node_count;
+  int unused;                // first unused node, -1 if none
+  int size[REPLACE_LISTS];
+  int target;                // ARC: target size of T1
+  int hand;                  // CLOCK: next node to look at, may be the list head
+  int *map;                  // open addressing hash map from key to node, -1 if empty
+  int map_capacity;
+} replacer_t;
+
+replacer_t *replace_alloc(replace_policy_t policy, int capacity);
+void replace_free(replacer_t *r);
+
+/* Adds the bytes held by live replacers to stats. */
+void replace_mem_stats(mem_stats_t *stats);
+
+/* Records an access to a resident page. */
+void replace_touch(replacer_t *r, uint64_t key);
+
+/* Makes a page resident. If every frame is taken, returns true and sets
+ * *victim to the resident page that has to give its frame up first; the
+ * victim no longer counts as resident. */
+bool replace_admit(replacer_t *r, uint64_t key, uint64_t *victim);
+
+/* Forgets an unmapped page, whether resident or only remembered. */
+void replace_remove(replacer_t *r, uint64_t key);
+
+#endif /* REPLACE_H */
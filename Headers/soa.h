@@ -0,0 +1,66 @@
+// soa.h
+//
+// Interface definition for the structure-of-arrays free block store.
+//
+// An alternative free list backend: the start and size of every free block
+// are kept in two packed int arrays, in free list order, and the fit policies
+// are evaluated by vectorized compare-and-reduce kernels over the size array.
+#ifndef SOA_H
+#define SOA_H
+
+#include "pool.h"
+
+/* Instruction set used by the search kernels. */
+typedef enum soa_isa {
+  SOA_SCALAR,
+  SOA_SSE,    // SSE4.1, 4 sizes per compare
+  SOA_AVX2    // AVX2, 8 sizes per compare
+} soa_isa_t;
+
+/* Search kernels. Each returns an index into size[0..n) or -1. */
+typedef int (*soa_kernel_fn)(const int *size, int n, int request);
+
+typedef struct soa_store {
+  int *start;
+  int *size;
+  int count;
+  int capacity;
+  soa_isa_t isa;
+  soa_kernel_fn first_fit;  // first index with size >= request
+  soa_kernel_fn best_fit;   // first index of the smallest size >= request
+  soa_kernel_fn worst_fit;  // first index of the largest size, if >= request
+  int rover;                // next fit resume index, kept valid by soa_remove
+  struct soa_store *prev, *next;  // chain of live stores for soa_release_all
+} soa_store_t;
+
+/* Returns the widest instruction set the running CPU supports. */
+soa_isa_t soa_best_isa();
+
+soa_store_t *soa_alloc(soa_isa_t isa);
+void soa_free(soa_store_t *store);
+
+/* Frees every live store. */
+void soa_release_all();
+
+/* Adds the bytes held by live stores to stats. */
+void soa_mem_stats(mem_stats_t *stats);
+
+/* Appends a free block [start, end]. */
+void soa_push(soa_store_t *store, int start, int end);
+
+/* Removes entry i, keeping the order of the others. */
+void soa_remove(soa_store_t *store, int i);
+
+/* Returns the entry starting at start, or -1. */
+int soa_find_start(soa_store_t *store, int start);
+
+/* Returns the entry the policy (1 first fit, 2 best fit, 3 worst fit, 4 next
+ * fit from the rover) would allocate a request of this size from, or -1.
+ * Ties go to the lowest index. */
+int soa_find_fit(soa_store_t *store, int request, int policy);
+
+/* Sorts the entries by address and merges physically adjacent ones. The rover
+ * follows the address it was on. */
+void soa_coalesce(soa_store_t *store);
+
+#endif /* SOA_H */
@@ -13,5 +13,27 @@ void test_list_add_to_freelist();
 void test_remove_block_from_freelist();
 void test_allocate_memory_edge_cases();
 void test_deallocate_memory_edge_cases();
+void test_allocate_memory_indexed();
+void test_deallocate_memory_eager();
+void test_deallocate_memory_pid_index();
+void test_pool_recycling();
+void test_intrusive_nodes();
+void test_allocate_memory_soa();
+void test_trace_reader();
+void test_trace_binary();
+void test_free_list_summary();
+void test_allocate_memory_next_fit();
+void test_buddy_engine();
+void test_tlsf_engine();
+void test_quick_lists();
+void test_compact_memory();
+void test_allocate_memory_lazy();
+void test_allocate_memory_batch();
+void test_resize_memory();
+void test_deallocate_memory_pid_chain();
+void test_query_address();
+void test_paging_engine();
+void test_tlb();
+void test_page_replacement();
 
 #endif /* TEST_H */
@@ -0,0 +1,85 @@
+// tlb.h
+//
+// Interface definition for the TLB model.
+//
+// A set associative cache of page translations: entries / ways sets of ways
+// entries each, a page going to set vpn % sets. A full set gives up the way
+// the replacement policy picks. Without PID tags only one address space can
+// be cached at a time, so a lookup for another PID than the last one flushes
+// the whole TLB first; with tags entries of different PIDs live side by side.
+// Hits, misses and flushes are counted per PID.
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pool.h"
+
+#define TLB_PLRU_MAX_WAYS 32   // the tree bits of a set fit in an unsigned int
+
+typedef enum tlb_policy {
+  TLB_LRU,      // least recently used, by access stamps
+  TLB_PLRU,     // tree pseudo-LRU, ways - 1 bits per set
+  TLB_RANDOM
+} tlb_policy_t;
+
+typedef struct tlb_entry {
+  long vpn;
+  int pid;         // only compared with PID tags
+  int base;        // physical address of the page's first byte
+  uint64_t stamp;  // last use, for TLB_LRU
+  int size;        // bytes of the page that are mapped, from base
+  bool valid;
+} tlb_entry_t;
+
+typedef struct tlb_pid_stats {
+  int pid;         // 0 marks an empty slot
+  long hits;
+  long misses;
+  long flushes;    // full flushes caused by switching to this PID
+} tlb_pid_stats_t;
+
+typedef struct tlb {
+  tlb_entry_t *entries;       // set s is entries[s * ways, (s + 1) * ways)
+  unsigned int *plru;         // tree bits of each set, for TLB_PLRU
+  int sets, ways;
+  tlb_policy_t policy;
+  bool tagged;                // entries carry PID tags
+  int current_pid;            // PID of the last lookup, 0 before the first
+  tlb_pid_stats_t *current;   // its stats
+  uint64_t clock;             // next LRU stamp
+  uint64_t rng;               // TLB_RANDOM state
+  tlb_pid_stats_t *stats;     // open addressing hash map by PID
+  int stats_capacity, stats_used;
+  long invalidations;         // entries dropped because their page went away
+} tlb_t;
+
+/* Returns a TLB of entries entries, or NULL if the geometry is not supported:
+ * ways has to divide entries into a power of two number of sets, and be a
+ * power of two of at most TLB_PLRU_MAX_WAYS for TLB_PLRU. */
+tlb_t *tlb_alloc(int entries, int ways, tlb_policy_t policy, bool tagged);
+void tlb_free(tlb_t *tlb);
+
+/* Adds the bytes held by live TLBs to stats. */
+void tlb_mem_stats(mem_stats_t *stats);
+
+/* Looks up page vpn of pid, counting a hit or a miss. On a hit *base is set
+ * to the physical address of the page and *size to the bytes of it that are
+ * mapped, less than a page where a block ends part way into it. */
+bool tlb_lookup(tlb_t *tlb, int pid, long vpn, int *base, int *size);
+
+/* Caches a translation after a miss, in place of the victim of the policy. */
+void tlb_insert(tlb_t *tlb, int pid, long vpn, int base, int size);
+
+/* Drops every cached page of pid, or every page without PID tags, after its
+ * mappings changed. */
+void tlb_invalidate_pid(tlb_t *tlb, int pid);
+void tlb_invalidate_all(tlb_t *tlb);
+
+/* Drops the cached translation of one page of pid, if any. */
+void tlb_invalidate_page(tlb_t *tlb, int pid, long vpn);
+
+/* Prints the hits, misses and flushes of every PID, then the totals. */
+void tlb_print_stats(tlb_t *tlb);
+
+#endif /* TLB_H */
@@ -0,0 +1,65 @@
+// tlsf.h
+//
+// Interface definition for the two-level segregated fit (TLSF) engine.
+//
+// Free blocks are kept in segregated lists indexed by a first level, the
+// power of two of the block size, and a second level that splits each power
+// of two into TLSF_SL_COUNT equal ranges. One bitmap marks the first levels
+// with a non-empty list and one per first level marks its non-empty second
+// levels, so a fitting list is found with two find-first-set operations and
+// both allocation and free take constant time. Every block, free or used, has
+// a header linked to its physical neighbours (its boundary tags), so a freed
+// block is merged with free neighbours immediately.
+#ifndef TLSF_H
+#define TLSF_H
+
+#include <stdbool.h>
+#include "pool.h"
+
+#define TLSF_SL_LOG2 4
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2)
+#define TLSF_FL_COUNT 31   // block sizes up to INT_MAX
+
+typedef struct tlsf_header {
+  int start;
+  int size;
+  int phys_prev, phys_next;  // headers of the physical neighbours, -1 at the ends
+  int free_prev, free_next;  // segregated list links; free_next also chains unused headers
+  bool free;
+} tlsf_header_t;
+
+typedef struct tlsf {
+  tlsf_header_t *hdr;        // headers are referred to by index
+  int count, capacity;
+  int unused;                // recycled header slots, -1 if none
+  int first;                 // header at the lowest address, -1 if none
+  int last;                  // header at the highest address, -1 if none
+  int free_blocks;
+  unsigned int fl_bitmap;
+  unsigned int sl_bitmap[TLSF_FL_COUNT];
+  int heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+  struct tlsf *prev, *next;  // chain of live engines for tlsf_release_all
+} tlsf_t;
+
+tlsf_t *tlsf_alloc();
+void tlsf_free(tlsf_t *tlsf);
+
+/* Frees every live engine. */
+void tlsf_release_all();
+
+/* Adds the bytes held by live engines to stats. */
+void tlsf_mem_stats(mem_stats_t *stats);
+
+/* Adds [start, end] as free memory. Ranges have to be added in ascending
+ * address order; a gap between two ranges becomes a used block that is never
+ * released, so blocks never merge across it. */
+void tlsf_add_range(tlsf_t *tlsf, int start, int end);
+
+/* Allocates size bytes from the front of a free block, splitting off the
+ * rest. Returns the header of the allocated block, or -1 if no block fits. */
+int tlsf_take(tlsf_t *tlsf, int size);
+
+/* Frees the block of header h and merges it with its free neighbours. */
+void tlsf_release(tlsf_t *tlsf, int h);
+
+#endif /* TLSF_H */
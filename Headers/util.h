@@ -2,12 +2,87 @@
 #define UTIL_H
 
 #include <stdio.h> // Include the necessary header file
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * Utility function file
  */
 
-void parse_file(FILE *, int[][2], int *, int *);
+#define TRACE_BUFFER_SIZE (1 << 20)
+
+/* Trace operations. An operation is "<pid> <size>" (allocate, pid > 0),
+ * "-<pid> 0" (free) or one of the reserved opcodes below in place of the pid.
+ * Opcodes that take two operands are followed by both on the same line:
+ *
+ *   -99999 0                 coalesce / compact
+ *   -99998 <pid> <size>      resize the block of pid to size bytes
+ *   -99997 <pid> <start>     free the block of pid that starts at start
+ *   -99996 <lo> <hi>         look up the owner of the addresses lo..hi
+ *   -99995 <pid> <vaddr>     access virtual address vaddr of pid
+ *
+ * trace_next returns every operation as TRACE_OP_WORDS ints, unused ones 0. */
+#define TRACE_OP_COALESCE -99999
+#define TRACE_OP_RESIZE -99998
+#define TRACE_OP_FREE_AT -99997
+#define TRACE_OP_QUERY -99996
+#define TRACE_OP_ACCESS -99995
+#define TRACE_OP_WORDS 3
+
+/* Binary trace format. All fields are little-endian. The file is a
+ * TRACE_BIN_HEADER_SIZE byte header followed by op_count fixed width records
+ * of TRACE_OP_WORDS int32 values, the operation as trace_next returns it.
+ * Version 1 files, with two int32 values per record and no opcodes taking
+ * two operands, are still read.
+ *
+ *   offset  size  field
+ *   0       4     magic "MMUT"
+ *   4       4     version (TRACE_BIN_VERSION)
+ *   8       4     partition size
+ *   12      4     record size in bytes (TRACE_BIN_RECORD_SIZE)
+ *   16      8     op_count
+ */
+#define TRACE_BIN_MAGIC "MMUT"
+#define TRACE_BIN_VERSION 2
+#define TRACE_BIN_HEADER_SIZE 24
+#define TRACE_BIN_RECORD_SIZE 12
+#define TRACE_BIN_V1_RECORD_SIZE 8
+
+/* Streaming reader for trace files. A text trace is read in large blocks into
+ * a fixed buffer and parsed incrementally, so a trace of any length is
+ * replayed in constant memory. A binary trace is memory mapped and its
+ * records are handed out as they are, with no parsing. */
+typedef struct trace_reader {
+  int fd;
+  char *buf;           // TRACE_BUFFER_SIZE bytes (text traces), NULL for binary
+  size_t len;          // bytes currently in buf
+  size_t pos;          // parse position in buf
+  bool eof;
+  bool error;          // a malformed token stopped the parse
+  int partition_size;
+  const unsigned char *map;  // mapped binary trace, NULL for text
+  size_t map_size;
+  uint64_t op_count;   // records in a binary trace
+  uint64_t next_op;
+  size_t record_size;  // bytes per binary record, by version
+} trace_reader_t;
+
+/* Opens a text or binary trace (told apart by the magic) and reads its
+ * partition size (printed as "PARTITION_SIZE = n"). Returns NULL if the file
+ * cannot be opened. */
+trace_reader_t *trace_open(const char *path);
+
+/* Reads the next operation into op (see TRACE_OP_WORDS). Returns false at
+ * the end of the trace or on a malformed entry. */
+bool trace_next(trace_reader_t *trace, int op[TRACE_OP_WORDS]);
+
+void trace_close(trace_reader_t *trace);
+
+/* Converts a text trace to the binary format. Returns the number of
+ * operations written, -1 if either file cannot be opened, or -2 (reported on
+ * stderr) if the text trace is malformed or the binary cannot be written. */
+long trace_convert(const char *text_path, const char *bin_path);
 
 
 #endif // UTIL_H
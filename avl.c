@@ -0,0 +1,359 @@
+// avl.c
+//
+// Implementation for the ordered block index (AVL tree).
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "./Headers/avl.h"
+#include "./Headers/pool.h"
+
+/* Trees and their entries are carved from these pools. */
+static pool_t tree_pool = POOL_INIT(sizeof(avl_tree_t));
+static pool_t entry_pool = POOL_INIT(sizeof(avl_node_t));
+
+/***** Key Functions ********/
+
+int avl_key_size(const block_t *blk) {
+    return blk->end - blk->start + 1;
+}
+
+int avl_key_size_desc(const block_t *blk) {
+    return -(blk->end - blk->start + 1);
+}
+
+int avl_key_start(const block_t *blk) {
+    return blk->start;
+}
+
+/***** Helpers ********/
+
+static int height(avl_node_t *n) {
+    return n ? n->height : 0;
+}
+
+static void update_height(avl_node_t *n) {
+    int hl = height(n->left), hr = height(n->right);
+    n->height = (hl > hr ? hl : hr) + 1;
+}
+
+/* Returns the tie of a block that carries its stamp (or start) already. */
+static int tie_of(const avl_tree_t *tree, const block_t *blk) {
+    if (tree->order == AVL_TIE_OLDEST_FIRST)
+        return blk->tag;
+    if (tree->order == AVL_TIE_NEWEST_FIRST)
+        return -blk->tag;
+    return blk->start;
+}
+
+/* Orders (key, tie) pairs the same way the tree does. */
+static int compare_keys(int key_a, int tie_a, int key_b, int tie_b) {
+    if (key_a != key_b)
+        return key_a < key_b ? -1 : 1;
+    if (tie_a != tie_b)
+        return tie_a < tie_b ? -1 : 1;
+    return 0;
+}
+
+static avl_node_t *rotate_right(avl_node_t *n) {
+    avl_node_t *l = n->left;
+    n->left = l->right;
+    l->right = n;
+    update_height(n);
+    update_height(l);
+    return l;
+}
+
+static avl_node_t *rotate_left(avl_node_t *n) {
+    avl_node_t *r = n->right;
+    n->right = r->left;
+    r->left = n;
+    update_height(n);
+    update_height(r);
+    return r;
+}
+
+static avl_node_t *rebalance(avl_node_t *n) {
+    update_height(n);
+    int balance = height(n->left) - height(n->right);
+
+    if (balance > 1) {
+        if (height(n->left->left) < height(n->left->right))
+            n->left = rotate_left(n->left);
+        return rotate_right(n);
+    }
+    if (balance < -1) {
+        if (height(n->right->right) < height(n->right->left))
+            n->right = rotate_right(n->right);
+        return rotate_left(n);
+    }
+    return n;
+}
+
+static avl_node_t *insert_at(avl_node_t *root, avl_node_t *entry) {
+    if (root == NULL)
+        return entry;
+
+    if (compare_keys(entry->key, entry->tie, root->key, root->tie) < 0)
+        root->left = insert_at(root->left, entry);
+    else
+        root->right = insert_at(root->right, entry);
+
+    return rebalance(root);
+}
+
+/* Detaches the minimum entry of a subtree; the entry is returned through min. */
+static avl_node_t *remove_min(avl_node_t *root, avl_node_t **min) {
+    if (root->left == NULL) {
+        *min = root;
+        return root->right;
+    }
+    root->left = remove_min(root->left, min);
+    return rebalance(root);
+}
+
+static avl_node_t *remove_at(avl_node_t *root, int key, int tie, bool *found) {
+    if (root == NULL)
+        return NULL;
+
+    int cmp = compare_keys(key, tie, root->key, root->tie);
+    if (cmp < 0) {
+        root->left = remove_at(root->left, key, tie, found);
+    }
+    else if (cmp > 0) {
+        root->right = remove_at(root->right, key, tie, found);
+    }
+    else {
+        avl_node_t *left = root->left, *right = root->right;
+        pool_free(&entry_pool, root);
+        *found = true;
+
+        if (right == NULL)
+            return left;
+
+        avl_node_t *min;
+        right = remove_min(right, &min);
+        min->left = left;
+        min->right = right;
+        return rebalance(min);
+    }
+    return rebalance(root);
+}
+
+/* Hands out stamps 1, 2, ... again in the order the entries were stamped,
+ * which keeps their order and makes room before the stamps overflow. */
+static void restamp(avl_tree_t *tree, avl_node_t *root) {
+    if (root == NULL)
+        return;
+    restamp(tree, root->left);
+    if (tree->order == AVL_TIE_OLDEST_FIRST)
+        root->node->blk->tag = ++tree->stamp;
+    else
+        root->node->blk->tag = tree->count - tree->stamp++;  // in-order is newest first
+    root->tie = tie_of(tree, root->node->blk);
+    restamp(tree, root->right);
+}
+
+/* Returns the entry with this key and tie, or NULL, in O(log n). */
+static avl_node_t *find_exact(avl_node_t *root, int key, int tie) {
+    while (root != NULL) {
+        int cmp = compare_keys(key, tie, root->key, root->tie);
+        if (cmp == 0)
+            return root;
+        root = cmp < 0 ? root->left : root->right;
+    }
+    return NULL;
+}
+
+/* Looks for the entry of the block with this key and start among the entries
+ * of equal key, which in a stamped tree are not ordered by start. */
+static avl_node_t *find_at(avl_node_t *root, int key, int start) {
+    if (root == NULL)
+        return NULL;
+    if (key != root->key)
+        return find_at(key < root->key ? root->left : root->right, key, start);
+    if (root->node->blk->start == start)
+        return root;
+
+    avl_node_t *found = find_at(root->left, key, start);
+    return found != NULL ? found : find_at(root->right, key, start);
+}
+
+static void free_subtree(avl_node_t *root) {
+    if (root != NULL) {
+        free_subtree(root->left);
+        free_subtree(root->right);
+        pool_free(&entry_pool, root);
+    }
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: avl_alloc
+ * -------------------
+ * Allocates an empty index ordered by the given key function, with equal keys
+ * ordered as order says.
+ *
+ * Returns:
+ *  A pointer to the new tree. Exits with a failure status if the pool cannot grow.
+ */
+avl_tree_t *avl_alloc(avl_key_fn key, avl_tie_t order) {
+    avl_tree_t *tree = pool_alloc(&tree_pool);
+
+    tree->root = NULL;
+    tree->key = key;
+    tree->order = order;
+    tree->stamp = 0;
+    tree->count = 0;
+    return tree;
+}
+
+/**
+ * Function: avl_free
+ * ------------------
+ * Frees the tree and its entries. The indexed list nodes are left untouched.
+ */
+void avl_free(avl_tree_t *tree) {
+    if (tree != NULL) {
+        free_subtree(tree->root);
+        pool_free(&tree_pool, tree);
+    }
+}
+
+/**
+ * Function: avl_release_all
+ * -------------------------
+ * Frees every tree and entry in one bulk release of their pools.
+ */
+void avl_release_all() {
+    pool_release(&entry_pool);
+    pool_release(&tree_pool);
+}
+
+void avl_mem_stats(mem_stats_t *stats) {
+    pool_mem_stats(&tree_pool, stats);
+    pool_mem_stats(&entry_pool, stats);
+}
+
+/**
+ * Function: avl_insert
+ * --------------------
+ * Adds an entry for node, keyed on the current contents of node->blk.
+ */
+void avl_insert(avl_tree_t *tree, node_t *node) {
+    avl_node_t *entry = pool_alloc(&entry_pool);
+
+    if (tree->order != AVL_TIE_START) {
+        if (tree->stamp == INT_MAX) {
+            tree->stamp = 0;
+            restamp(tree, tree->root);
+        }
+        node->blk->tag = ++tree->stamp;
+    }
+
+    entry->node = node;
+    entry->key = tree->key(node->blk);
+    entry->tie = tie_of(tree, node->blk);
+    entry->height = 1;
+    entry->left = entry->right = NULL;
+
+    tree->root = insert_at(tree->root, entry);
+    tree->count++;
+}
+
+/**
+ * Function: avl_remove
+ * --------------------
+ * Removes the entry for node. Does nothing if the block is not indexed.
+ */
+void avl_remove(avl_tree_t *tree, node_t *node) {
+    bool found = false;
+    tree->root = remove_at(tree->root, tree->key(node->blk), tie_of(tree, node->blk), &found);
+    if (found)
+        tree->count--;
+}
+
+node_t *avl_find(avl_tree_t *tree, block_t *blk) {
+    int key = tree->key(blk);
+    avl_node_t *found = find_exact(tree->root, key, tie_of(tree, blk));
+
+    // A copy of an indexed block does not carry its stamp
+    if (tree->order != AVL_TIE_START && (found == NULL || found->node->blk->start != blk->start))
+        found = find_at(tree->root, key, blk->start);
+    return found != NULL ? found->node : NULL;
+}
+
+node_t *avl_first(avl_tree_t *tree) {
+    avl_node_t *curr = tree->root;
+    if (curr == NULL)
+        return NULL;
+    while (curr->left != NULL)
+        curr = curr->left;
+    return curr->node;
+}
+
+node_t *avl_last(avl_tree_t *tree) {
+    avl_node_t *curr = tree->root;
+    if (curr == NULL)
+        return NULL;
+    while (curr->right != NULL)
+        curr = curr->right;
+    return curr->node;
+}
+
+node_t *avl_lower_bound(avl_tree_t *tree, int key) {
+    avl_node_t *curr = tree->root;
+    node_t *best = NULL;
+
+    while (curr != NULL) {
+        if (curr->key >= key) {
+            best = curr->node;
+            curr = curr->left;
+        }
+        else {
+            curr = curr->right;
+        }
+    }
+    return best;
+}
+
+node_t *avl_floor(avl_tree_t *tree, int key) {
+    avl_node_t *curr = tree->root;
+    node_t *best = NULL;
+
+    while (curr != NULL) {
+        if (curr->key <= key) {
+            best = curr->node;
+            curr = curr->right;
+        }
+        else {
+            curr = curr->left;
+        }
+    }
+    return best;
+}
+
+node_t *avl_successor(avl_tree_t *tree, block_t *blk) {
+    int key = tree->key(blk);
+    int tie = blk->start;
+    avl_node_t *curr = tree->root;
+    node_t *best = NULL;
+
+    if (tree->order == AVL_TIE_OLDEST_FIRST)
+        tie = INT_MAX;   // after every block of its key
+    else if (tree->order == AVL_TIE_NEWEST_FIRST)
+        tie = INT_MIN;   // before every block of its key
+
+    while (curr != NULL) {
+        if (compare_keys(curr->key, curr->tie, key, tie) > 0) {
+            best = curr->node;
+            curr = curr->left;
+        }
+        else {
+            curr = curr->right;
+        }
+    }
+    return best;
+}
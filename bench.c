@@ -0,0 +1,508 @@
+// bench.c
+//
+// Allocator benchmark harness.
+//
+// Generates seeded synthetic workloads in process and replays each of them
+// against every allocation policy, reporting throughput, per operation
+// latency percentiles, peak metadata memory and the final fragmentation of
+// the free list. Every (workload, policy) run happens in a child process, so
+// the runs cannot disturb each other's pools or high water marks.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "./Headers/list.h"
+#include "./Headers/pool.h"
+#include "./Headers/soa.h"
+#include "./Headers/buddy.h"
+#include "./Headers/paging.h"
+#include "./Headers/mmu.h"
+
+#define BENCH_PARTITION_SIZE (1 << 22)
+#define BENCH_LIVE_TARGET 512       // mean number of live allocations
+#define BENCH_COALESCE_EVERY 4096   // a coalesce operation every N operations
+#define BENCH_PAGE_SIZE 256         // page size of the paging engine
+#define BENCH_PAGE_LEVELS 2
+
+typedef struct bench_options {
+  long ops;
+  unsigned long seed;
+  const char *csv_path;
+  const char *only;      // run just this workload, or NULL
+  bool indexed;          // -I: size indexed free list
+  bool soa;              // -S: packed array free list
+  bool quick;            // -K: size class quick lists in front of the free list
+} bench_options_t;
+
+typedef struct bench_result {
+  long ops;
+  double ops_per_sec;
+  long p50_ns, p99_ns, p999_ns;
+  size_t meta_peak;      // bytes, see list_mem_stats
+  int free_bytes, holes, largest;
+  long failed;           // allocations that found no hole
+} bench_result_t;
+
+static const struct {
+  int policy;
+  const char *name;
+} policies[] = {
+  {1, "FIFO"},
+  {2, "BESTFIT"},
+  {3, "WORSTFIT"},
+  {4, "NEXTFIT"},
+  {5, "BUDDY"},
+  {6, "TLSF"},
+  {7, "PAGING"},
+};
+
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+
+/***** Random Numbers ********/
+
+static uint64_t rng_state;
+
+/* xorshift64* */
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+/* Uniform in (0, 1]. */
+static double rng_unit(void) {
+    return ((rng_next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static int rng_range(int lo, int hi) {
+    return lo + (int)(rng_next() % (uint64_t)(hi - lo + 1));
+}
+
+static double rng_exponential(double mean) {
+    return -mean * log(rng_unit());
+}
+
+/***** Size Distributions ********/
+
+typedef int (*size_fn)(void);
+
+static int size_uniform(void) {
+    return rng_range(1, 4096);
+}
+
+/* Pareto with alpha 1.2 from 16 bytes, capped at 64 KiB. */
+static int size_power_law(void) {
+    double size = 16.0 / pow(rng_unit(), 1.0 / 1.2);
+    return size > 65536.0 ? 65536 : (int)size;
+}
+
+/* Mostly small objects with a minority of large buffers. */
+static int size_bimodal(void) {
+    if (rng_next() % 5 != 0)
+        return rng_range(16, 128);
+    return rng_range(4096, 16384);
+}
+
+static int size_large(void) {
+    return rng_range(2048, 8192);
+}
+
+/***** Workload Generators ********/
+
+/* Operations are generated up front in the trace format: <pid> <size> to
+ * allocate, <-pid> 0 to free, -99999 0 to coalesce. */
+typedef struct workload {
+  int (*ops)[2];
+  long count;
+  long capacity;
+  int next_pid;
+  int *live;             // pids allocated and not yet freed
+  int live_count;
+} workload_t;
+
+static void emit(workload_t *w, int a, int b) {
+    w->ops[w->count][0] = a;
+    w->ops[w->count][1] = b;
+    w->count++;
+    if (w->count % BENCH_COALESCE_EVERY == 0 && w->count < w->capacity) {
+        w->ops[w->count][0] = -99999;
+        w->ops[w->count][1] = 0;
+        w->count++;
+    }
+}
+
+static void emit_alloc(workload_t *w, int size) {
+    w->live[w->live_count++] = w->next_pid;
+    emit(w, w->next_pid++, size);
+}
+
+/* Frees the live allocation at index i. */
+static void emit_free(workload_t *w, int i) {
+    int pid = w->live[i];
+    w->live[i] = w->live[--w->live_count];
+    emit(w, -pid, 0);
+}
+
+/* Allocates and frees at random around BENCH_LIVE_TARGET live objects, with
+ * sizes drawn from sizes. */
+static void steady_ops(workload_t *w, long until, size_fn sizes) {
+    while (w->count < until) {
+        int live = w->live_count;
+        if (live == 0 ||
+            (live < 2 * BENCH_LIVE_TARGET &&
+             rng_unit() < (double)BENCH_LIVE_TARGET / (BENCH_LIVE_TARGET + live)))
+            emit_alloc(w, sizes());
+        else
+            emit_free(w, rng_next() % live);
+    }
+}
+
+static void gen_uniform(workload_t *w) {
+    steady_ops(w, w->capacity, size_uniform);
+}
+
+static void gen_power_law(workload_t *w) {
+    steady_ops(w, w->capacity, size_power_law);
+}
+
+static void gen_bimodal(workload_t *w) {
+    steady_ops(w, w->capacity, size_bimodal);
+}
+
+/* Poisson arrivals (rate 1) with exponentially distributed lifetimes whose
+ * mean keeps BENCH_LIVE_TARGET objects alive on average (Little's law). The
+ * pending deaths are kept in a binary min-heap on time. */
+static void gen_poisson(workload_t *w) {
+    struct death { double time; int pid; } *heap;
+    int n = 0;
+    double now = 0.0;
+
+    heap = malloc(w->capacity * sizeof(*heap));
+    if (heap == NULL) {
+        fprintf(stderr, "Error: bench out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (w->count < w->capacity) {
+        double arrival = now + rng_exponential(1.0);
+
+        while (n > 0 && heap[0].time <= arrival && w->count < w->capacity) {
+            emit(w, -heap[0].pid, 0);
+            heap[0] = heap[--n];
+            for (int i = 0;;) {  // sift down
+                int c = 2 * i + 1;
+                if (c >= n)
+                    break;
+                if (c + 1 < n && heap[c + 1].time < heap[c].time)
+                    c++;
+                if (heap[i].time <= heap[c].time)
+                    break;
+                struct death t = heap[i]; heap[i] = heap[c]; heap[c] = t;
+                i = c;
+            }
+        }
+        if (w->count == w->capacity)
+            break;
+
+        now = arrival;
+        heap[n].time = now + rng_exponential(BENCH_LIVE_TARGET);
+        heap[n].pid = w->next_pid;
+        for (int i = n++; i > 0 && heap[(i - 1) / 2].time > heap[i].time; i = (i - 1) / 2) {  // sift up
+            struct death t = heap[i]; heap[i] = heap[(i - 1) / 2]; heap[(i - 1) / 2] = t;
+        }
+        emit(w, w->next_pid++, size_uniform());
+    }
+    free(heap);
+}
+
+/* Eight phases cycling through small, heavy tailed, bimodal and large
+ * requests; objects from earlier phases stay live across the shifts. */
+static void gen_phases(workload_t *w) {
+    static const size_fn mix[] = { size_uniform, size_power_law, size_bimodal, size_large };
+    long phase_len = w->capacity / 8 + 1;
+
+    for (int phase = 0; w->count < w->capacity; phase++) {
+        long until = w->count + phase_len;
+        steady_ops(w, until < w->capacity ? until : w->capacity, mix[phase % 4]);
+    }
+}
+
+static const struct {
+  const char *name;
+  void (*generate)(workload_t *w);
+} workloads[] = {
+  {"uniform", gen_uniform},
+  {"power-law", gen_power_law},
+  {"bimodal", gen_bimodal},
+  {"poisson", gen_poisson},
+  {"phases", gen_phases},
+};
+
+#define NUM_WORKLOADS ((int)(sizeof(workloads) / sizeof(workloads[0])))
+
+/***** Replay ********/
+
+static long elapsed_ns(const struct timespec *a, const struct timespec *b) {
+    return (b->tv_sec - a->tv_sec) * 1000000000L + (b->tv_nsec - a->tv_nsec);
+}
+
+static int compare_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+static long percentile(const long *sorted, long n, double p) {
+    long i = (long)(p * n);
+    return sorted[i < n ? i : n - 1];
+}
+
+/**
+ * Function: replay
+ * ----------------
+ * Replays a generated workload against one policy, the way main does, and
+ * times every operation.
+ */
+static void replay(const workload_t *w, int policy, const bench_options_t *opts,
+                   bench_result_t *result) {
+    list_t *FREE_LIST = list_alloc();
+    list_t *ALLOC_LIST = list_alloc();
+    long *latency = malloc(w->count * sizeof(long));
+    struct timespec t0, t1, begin, end;
+    mem_stats_t meta = {0, 0};
+    paging_t *pager = NULL;
+
+    if (latency == NULL) {
+        fprintf(stderr, "Error: bench out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = BENCH_PARTITION_SIZE - 1;
+    list_add_to_front(FREE_LIST, partition);
+
+    if (policy == 5)
+        buddy_init(FREE_LIST);
+    else if (policy == 6)
+        list_use_tlsf(FREE_LIST);
+    else if (policy == 7)
+        pager = paging_alloc(BENCH_PARTITION_SIZE, BENCH_PAGE_SIZE, BENCH_PAGE_LEVELS);
+    else if (opts->indexed)
+        list_index_by_size(FREE_LIST, policy);
+    else if (opts->soa)
+        list_use_soa(FREE_LIST, soa_best_isa());
+    if (opts->quick && policy < 5)
+        list_use_quick(FREE_LIST, policy);
+    list_index_by_pid(ALLOC_LIST);
+    list_index_by_address(ALLOC_LIST);
+
+    result->failed = 0;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (long i = 0; i < w->count; i++) {
+        int pid = w->ops[i][0];
+
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (pager != NULL) {  // frames never need coalescing
+            if (pid != -99999 && pid > 0 && paging_map(pager, pid, w->ops[i][1]) < 0)
+                result->failed++;
+            else if (pid != -99999 && pid < 0)
+                paging_unmap(pager, -pid);
+        }
+        else if (pid != -99999 && pid > 0) {
+            int before = ALLOC_LIST->length;
+            allocate_memory(FREE_LIST, ALLOC_LIST, pid, w->ops[i][1], policy);
+            if (ALLOC_LIST->length == before)
+                result->failed++;
+        }
+        else if (pid != -99999 && pid < 0) {
+            deallocate_memory(ALLOC_LIST, FREE_LIST, -pid, policy);
+        }
+        else if (policy != 5) {  // buddies merge on free
+            FREE_LIST = coalese_memory(FREE_LIST);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        latency[i] = elapsed_ns(&t0, &t1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    qsort(latency, w->count, sizeof(long), compare_long);
+    result->ops = w->count;
+    result->ops_per_sec = w->count / (elapsed_ns(&begin, &end) / 1e9);
+    result->p50_ns = percentile(latency, w->count, 0.50);
+    result->p99_ns = percentile(latency, w->count, 0.99);
+    result->p999_ns = percentile(latency, w->count, 0.999);
+    free_list_summary(FREE_LIST, &result->free_bytes, &result->holes, &result->largest);
+    if (pager != NULL) {  // any free frame can back any page
+        result->free_bytes = result->largest = pager->frames.free * BENCH_PAGE_SIZE;
+        result->holes = 0;
+    }
+
+    list_mem_stats(&meta);
+    paging_mem_stats(&meta);
+    result->meta_peak = meta.peak;
+    paging_free(pager);
+
+    free(latency);
+    list_release_all();
+}
+
+/**
+ * Function: run_isolated
+ * ----------------------
+ * Runs replay in a child process and reads its result back through a pipe.
+ * The child's stderr, where allocation failures are reported, is discarded.
+ *
+ * Returns:
+ *  true on success, false if the child failed.
+ */
+static bool run_isolated(const workload_t *w, int policy, const bench_options_t *opts,
+                         bench_result_t *result) {
+    int fds[2], status;
+
+    fflush(stdout);
+    if (pipe(fds) != 0)
+        return false;
+
+    pid_t child = fork();
+    if (child < 0)
+        return false;
+    if (child == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0)
+            dup2(devnull, STDERR_FILENO);
+        close(fds[0]);
+        replay(w, policy, opts, result);
+        _exit(write(fds[1], result, sizeof(*result)) == sizeof(*result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], result, sizeof(*result));
+    close(fds[0]);
+    waitpid(child, &status, 0);
+    return got == sizeof(*result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/***** Driver ********/
+
+static void usage(void) {
+    printf("usage: ./mmu_bench [-OPS n] [-SEED s] [-CSV file] [-WORKLOAD name] [-I | -S] [-K]\n");
+    printf("workloads:");
+    for (int i = 0; i < NUM_WORKLOADS; i++)
+        printf(" %s", workloads[i].name);
+    printf("\n");
+    exit(1);
+}
+
+static void get_bench_options(int argc, char *argv[], bench_options_t *opts) {
+    opts->ops = 100000;
+    opts->seed = 1;
+    opts->csv_path = NULL;
+    opts->only = NULL;
+    opts->indexed = false;
+    opts->soa = false;
+    opts->quick = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+
+        if (strcasecmp(argv[i], "-OPS") == 0 && has_value)
+            opts->ops = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-SEED") == 0 && has_value)
+            opts->seed = strtoul(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-CSV") == 0 && has_value)
+            opts->csv_path = argv[++i];
+        else if (strcasecmp(argv[i], "-WORKLOAD") == 0 && has_value)
+            opts->only = argv[++i];
+        else if (strcasecmp(argv[i], "-I") == 0)
+            opts->indexed = true;
+        else if (strcasecmp(argv[i], "-S") == 0)
+            opts->soa = true;
+        else if (strcasecmp(argv[i], "-K") == 0)
+            opts->quick = true;
+        else
+            usage();
+    }
+
+    if (opts->ops < 1 || (opts->indexed && opts->soa))
+        usage();
+}
+
+int main(int argc, char *argv[])
+{
+    bench_options_t opts;
+    workload_t w;
+    FILE *csv = NULL;
+
+    get_bench_options(argc, argv, &opts);
+
+    if (opts.csv_path != NULL) {
+        csv = fopen(opts.csv_path, "w");
+        if (csv == NULL) {
+            fprintf(stderr, "Error: Invalid filepath\n");
+            exit(1);
+        }
+        fprintf(csv, "workload,policy,ops,ops_per_sec,p50_ns,p99_ns,p999_ns,"
+                     "meta_peak_bytes,free_bytes,holes,largest_hole,fragmentation,failed_allocs\n");
+    }
+
+    w.capacity = opts.ops;
+    w.ops = malloc(w.capacity * sizeof(*w.ops));
+    w.live = malloc(w.capacity * sizeof(int));
+    if (w.ops == NULL || w.live == NULL) {
+        fprintf(stderr, "Error: bench out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%ld operations per run, seed %lu, partition %d%s%s\n\n", opts.ops, opts.seed,
+           BENCH_PARTITION_SIZE, opts.indexed ? ", size indexed" : opts.soa ? ", packed array" : "",
+           opts.quick ? ", quick lists" : "");
+    printf("%-10s %-9s %12s %9s %9s %9s %10s %6s %6s %7s\n", "workload", "policy", "ops/s",
+           "p50 ns", "p99 ns", "p999 ns", "meta KiB", "holes", "frag%", "failed");
+
+    for (int i = 0; i < NUM_WORKLOADS; i++) {
+        if (opts.only != NULL && strcmp(opts.only, workloads[i].name) != 0)
+            continue;
+
+        rng_state = opts.seed * 0x9E3779B97F4A7C15ull + i + 1;  // never zero
+        w.count = 0;
+        w.next_pid = 1;
+        w.live_count = 0;
+        workloads[i].generate(&w);
+
+        for (int p = 0; p < NUM_POLICIES; p++) {
+            bench_result_t r;
+
+            if (!run_isolated(&w, policies[p].policy, &opts, &r)) {
+                fprintf(stderr, "Error: %s/%s run failed\n", workloads[i].name, policies[p].name);
+                continue;
+            }
+
+            // external fragmentation: share of free memory outside the largest hole
+            double frag = r.free_bytes > 0 ? 1.0 - (double)r.largest / r.free_bytes : 0.0;
+
+            printf("%-10s %-9s %12.0f %9ld %9ld %9ld %10.1f %6d %6.1f %7ld\n",
+                   workloads[i].name, policies[p].name, r.ops_per_sec, r.p50_ns, r.p99_ns,
+                   r.p999_ns, r.meta_peak / 1024.0, r.holes, 100.0 * frag, r.failed);
+            if (csv != NULL)
+                fprintf(csv, "%s,%s,%ld,%.0f,%ld,%ld,%ld,%zu,%d,%d,%d,%.4f,%ld\n",
+                        workloads[i].name, policies[p].name, r.ops, r.ops_per_sec, r.p50_ns,
+                        r.p99_ns, r.p999_ns, r.meta_peak, r.free_bytes, r.holes, r.largest,
+                        frag, r.failed);
+        }
+    }
+
+    if (csv != NULL)
+        fclose(csv);
+    free(w.ops);
+    free(w.live);
+    return 0;
+}
@@ -0,0 +1,167 @@
+// buddy.c
+//
+// Implementation for the binary buddy allocation engine.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/buddy.h"
+#include "./Headers/avl.h"
+
+/***** Helpers ********/
+
+#define BUDDY_MAX_ORDER 30   // the largest power of two an int partition holds
+
+/* Returns the order of the smallest power of two >= size. */
+static int order_of(int size) {
+    return size <= 1 ? 0 : 32 - __builtin_clz((unsigned int)(size - 1));
+}
+
+static int block_size(const block_t *blk) {
+    return blk->end - blk->start + 1;
+}
+
+/* Returns the node of the free block that starts at start, or NULL. */
+static node_t *find_free(list_t *freelist, int start) {
+    block_t key;
+    key.start = start;
+    key.end = start;  // only the start matters to the address index
+    return avl_find(freelist->addr_index, &key);
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: buddy_init
+ * --------------------
+ * Prepares a free list for the buddy engine.
+ *
+ * Description:
+ *  Each free range is carved from its start into the largest power of two
+ *  blocks that are aligned to their size and still fit, which for a partition
+ *  at 0 is its binary decomposition (100000 = 65536 + 32768 + 1024 + ...).
+ *  Blocks inside one of these pieces can only ever merge within it.
+ */
+void buddy_init(list_t *freelist) {
+    list_t *ranges = list_alloc();
+    block_t *blk;
+
+    while ((blk = list_remove_from_front(freelist)) != NULL)
+        list_add_to_back(ranges, blk);
+
+    list_index_by_size(freelist, 5);    // smallest block of at least an order, lowest first
+    list_index_by_address(freelist);    // buddy lookup
+
+    while ((blk = list_remove_from_front(ranges)) != NULL) {
+        int start = blk->start, end = blk->end;
+        block_free(blk);
+
+        while (start <= end) {
+            int k = 31 - __builtin_clz((unsigned int)(end - start + 1));  // largest 2^k <= remaining
+            while (k > 0 && start % (1 << k) != 0)
+                k--;
+
+            block_t *piece = block_alloc();
+            piece->pid = 0;
+            piece->start = start;
+            piece->end = start + (1 << k) - 1;
+            list_add_ascending_by_address(freelist, piece);
+            start += 1 << k;
+        }
+    }
+    list_free(ranges);
+}
+
+/**
+ * Function: buddy_allocate
+ * ------------------------
+ * Allocates size bytes for pid in O(log n).
+ *
+ * Description:
+ *  The size index returns the smallest free block of at least 2^k bytes,
+ *  k = ceil(log2(size)), lowest address first among blocks of that size. The block is halved until it
+ *  is 2^k bytes, each upper half going back to the free list, and the block
+ *  record itself moves to the allocated list. Returns the block, or NULL if
+ *  no free block is large enough; a request above 2^BUDDY_MAX_ORDER bytes
+ *  is turned down before the lookup.
+ */
+block_t *buddy_allocate(list_t *freelist, list_t *alloclist, int pid, int size) {
+    int k = order_of(size);
+    node_t *node;
+
+    if (k > BUDDY_MAX_ORDER)
+        return NULL;  // 1 << k would overflow, and no block is that large
+    node = avl_lower_bound(freelist->size_index, 1 << k);
+    if (node == NULL)
+        return NULL;
+
+    block_t *blk = node->blk;
+    list_remove_node(freelist, node);
+
+    while (block_size(blk) > (1 << k)) {
+        int half = block_size(blk) / 2;
+        block_t *upper = block_alloc();
+        upper->pid = 0;
+        upper->start = blk->start + half;
+        upper->end = blk->end;
+        list_add_ascending_by_address(freelist, upper);
+        blk->end = blk->start + half - 1;
+    }
+
+    blk->pid = pid;
+    blk->end = blk->start + (size > 0 ? size : 1) - 1;
+    list_add_ascending_by_address(alloclist, blk);
+    return blk;
+}
+
+/**
+ * Function: buddy_free
+ * --------------------
+ * Frees the allocated block at node in O(log n).
+ *
+ * Description:
+ *  The block is widened back to its buddy block. Its buddy is the block of
+ *  the same order whose start differs only in bit k; while that buddy is free
+ *  and whole, the two are merged and the search goes one order up.
+ */
+void buddy_free(list_t *alloclist, list_t *freelist, node_t *node) {
+    block_t *blk = node->blk;
+    list_remove_node(alloclist, node);
+
+    int k = order_of(block_size(blk));
+    blk->pid = 0;
+    blk->end = blk->start + (1 << k) - 1;
+
+    while (1) {
+        node_t *buddy_node = find_free(freelist, blk->start ^ (1 << k));
+        if (buddy_node == NULL || block_size(buddy_node->blk) != (1 << k))
+            break;
+
+        block_t *buddy = buddy_node->blk;
+        list_remove_node(freelist, buddy_node);
+        if (buddy->start < blk->start)
+            blk->start = buddy->start;
+        blk->end = blk->start + (2 << k) - 1;
+        block_free(buddy);
+        k++;
+    }
+
+    list_add_ascending_by_address(freelist, blk);
+}
+
+/**
+ * Function: buddy_stats
+ * ---------------------
+ * Totals the requested and the reserved bytes of the allocated blocks.
+ */
+void buddy_stats(list_t *alloclist, buddy_stats_t *stats) {
+    stats->blocks = 0;
+    stats->requested = stats->reserved = 0;
+
+    for (node_t *curr = alloclist->head; curr != NULL; curr = curr->next) {
+        int size = block_size(curr->blk);
+        stats->blocks++;
+        stats->requested += size;
+        stats->reserved += 1L << order_of(size);
+    }
+}
@@ -0,0 +1,767 @@
+// diff.c
+//
+// Differential harness against the reference binary.
+//
+// Generates seeded traces and replays each of them through mmu_ref and
+// through mmu with every optimized free list engine, for each policy mmu_ref
+// knows. The outputs are compared step by step and the first divergent step
+// is reported together with the wall time of every run. mmu_ref holds at
+// most DIFF_REF_MAX_OPS operations, so a longer trace then compares the
+// engines against plain mmu, which is where their speedup shows. Where
+// mmu_ref is known to be wrong, plain mmu stands in for it, and the failures
+// are counted apart from the mismatches.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define DIFF_REF_MAX_OPS 200          // mmu_ref reads the trace into a fixed array
+#define DIFF_PARTITION_SIZE 100000
+#define DIFF_LIVE_TARGET 24           // small enough that coalescing matters ...
+#define DIFF_MAX_SIZE 6000            // ... and large enough that allocations fail
+#define DIFF_COALESCE_ODDS 25         // a coalesce operation every 25 on average
+#define DIFF_SCALE_PARTITION_SIZE (1 << 22)
+#define DIFF_SCALE_LIVE_TARGET 512
+#define DIFF_SCALE_MAX_SIZE 4096
+#define DIFF_SCALE_COALESCE_ODDS 4096
+
+typedef struct diff_options {
+  int traces;
+  long ops;              // operations of the scaling trace, 0 to skip it
+  unsigned long seed;
+  const char *ref;       // reference binary
+  const char *mmu;
+  int timeout;           // seconds a run may take before it is killed
+  int scale_timeout;     // ... on the scaling trace
+  bool strict;           // compare the output text, list order included
+  bool keep;             // keep the generated traces
+} diff_options_t;
+
+typedef enum ref_fault {
+  REF_SOUND,
+  REF_CRASHES,   // mmu_ref dies part way through the trace
+  REF_WRONG      // mmu_ref runs, but places blocks where the policy does not
+} ref_fault_t;
+
+/* mmu_ref's best fit crashes on the generated traces, and its worst fit
+ * does not always take the largest hole. */
+static const struct {
+  const char *flag;
+  const char *name;
+  ref_fault_t ref;
+  bool ties;               // holes of equal size compete
+  bool coalesce_reorders;  // a coalesce leaves plain mmu's ties unreproducible
+} policies[] = {
+  {"-F", "FIFO", REF_SOUND, false, false},
+  {"-B", "BESTFIT", REF_CRASHES, true, false},
+  {"-W", "WORSTFIT", REF_WRONG, true, true},
+};
+
+/* Each engine is compared with mmu_ref and plain mmu on its own. Best and
+ * worst fit leave the choice between holes of equal size open: the size
+ * index takes the one plain mmu's list reaches first, but after a coalesce
+ * plain mmu's worst fit list is in no order it can follow, and the packed
+ * array takes the one it holds first, which is the oldest. The quick lists
+ * hand out the block of the size freed last, ahead of the policy.
+ * Divergences these allow are reported, but not counted as mismatches. */
+static const struct {
+  const char *flag;      // NULL for plain mmu
+  const char *name;
+  bool exact;            // follows the policy's choice of hole
+  bool exact_ties;       // ... and plain mmu's among holes of equal size
+} engines[] = {
+  {NULL, "plain", true, true},
+  {"-I", "indexed", true, true},
+  {"-S", "packed", true, false},
+  {"-K", "quick", false, false},
+};
+
+#define NUM_POLICIES ((int)(sizeof(policies) / sizeof(policies[0])))
+#define NUM_ENGINES ((int)(sizeof(engines) / sizeof(engines[0])))
+
+typedef enum run_status {
+  RUN_OK,
+  RUN_EXIT,      // exited with a non-zero code
+  RUN_SIGNAL,    // killed by a signal
+  RUN_TIMEOUT
+} run_status_t;
+
+typedef struct run {
+  run_status_t status;
+  int code;              // exit code or signal
+  double ms;             // wall time
+} run_t;
+
+/* An output split into lines, each tagged with the step that printed it.
+ * Step 0 is everything before the first operation. */
+typedef struct output {
+  char *text;
+  char **lines;
+  long *step;
+  long count;
+} output_t;
+
+/***** Random Numbers ********/
+
+static uint64_t rng_state;
+
+/* xorshift64* */
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static void *checked_malloc(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: mmu_diff out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/***** Traces ********/
+
+/* Fills ops with count operations in the trace format: <pid> <size> to
+ * allocate, <-pid> 0 to free, -99999 0 to coalesce. About live_target
+ * allocations are kept alive; a free always names a live PID. */
+static void gen_trace(int (*ops)[2], long count, int live_target, int max_size, int coalesce_odds) {
+    int *live = checked_malloc(count * sizeof(int));
+    int live_count = 0, next_pid = 1;
+
+    for (long i = 0; i < count; i++) {
+        if (rng_next() % coalesce_odds == 0) {
+            ops[i][0] = -99999;
+            ops[i][1] = 0;
+        }
+        else if (live_count == 0 || (live_count < 2 * live_target &&
+                                     rng_next() % (live_target + live_count) < (uint64_t)live_target)) {
+            live[live_count++] = next_pid;
+            ops[i][0] = next_pid++;
+            ops[i][1] = 1 + rng_next() % max_size;
+        }
+        else {
+            int j = rng_next() % live_count;
+            ops[i][0] = -live[j];
+            ops[i][1] = 0;
+            live[j] = live[--live_count];
+        }
+    }
+    free(live);
+}
+
+static void write_trace(const char *path, int partition_size, int (*ops)[2], long count) {
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL) {
+        fprintf(stderr, "Error: cannot write %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(f, "%d\n", partition_size);
+    for (long i = 0; i < count; i++)
+        fprintf(f, "%d %d\n", ops[i][0], ops[i][1]);
+    fclose(f);
+}
+
+/***** Runs ********/
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * Function: run_binary
+ * --------------------
+ * Runs binary on a trace with stdout sent to out_path.
+ *
+ * Description:
+ *  stderr is discarded: mmu prints its diagnostics there. The child arms an
+ *  alarm before exec, so a run that hangs dies of SIGALRM after timeout
+ *  seconds without the parent having to poll.
+ */
+static run_t run_binary(const char *binary, const char *trace, const char *policy, const char *flag,
+                        const char *output_flag, const char *out_path, int timeout) {
+    run_t run = {RUN_OK, 0, 0.0};
+    double start = now_ms();
+    int status;
+    pid_t child = fork();
+
+    if (child < 0) {
+        fprintf(stderr, "Error: fork failed\n");
+        exit(EXIT_FAILURE);
+    }
+    if (child == 0) {
+        char *argv[6];
+        int argc = 0;
+        int out = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        int devnull = open("/dev/null", O_WRONLY);
+
+        if (out < 0 || devnull < 0)
+            _exit(127);
+        dup2(out, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        argv[argc++] = (char *)binary;
+        argv[argc++] = (char *)trace;
+        argv[argc++] = (char *)policy;
+        if (flag != NULL)
+            argv[argc++] = (char *)flag;
+        if (output_flag != NULL)
+            argv[argc++] = (char *)output_flag;
+        argv[argc] = NULL;
+        alarm(timeout);
+        execv(binary, argv);
+        _exit(127);
+    }
+
+    waitpid(child, &status, 0);
+    run.ms = now_ms() - start;
+    if (WIFSIGNALED(status)) {
+        run.code = WTERMSIG(status);
+        run.status = run.code == SIGALRM ? RUN_TIMEOUT : RUN_SIGNAL;
+    }
+    else if (WEXITSTATUS(status) != 0) {
+        run.code = WEXITSTATUS(status);
+        run.status = RUN_EXIT;
+    }
+    return run;
+}
+
+static void print_failure(const run_t *run) {
+    if (run->status == RUN_TIMEOUT)
+        printf("timed out");
+    else if (run->status == RUN_SIGNAL)
+        printf("killed by %s", strsignal(run->code));
+    else
+        printf("exited with %d", run->code);
+}
+
+/***** Output Comparison ********/
+
+static int compare_lines(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static bool is_banner(const char *line) {
+    return line[0] == '*';
+}
+
+/**
+ * Function: load_output
+ * ---------------------
+ * Reads a run's output and splits it into steps.
+ *
+ * Description:
+ *  A step starts at the banner above an operation, or at a -SUMMARY line.
+ *  Lines starting with "Error:" are dropped: mmu_ref prints its diagnostics
+ *  on stdout. Unless strict, the block lines of each list lose their index
+ *  and are sorted, because the indexed engines print their free lists in
+ *  index order; the blocks themselves still have to match.
+ */
+static void load_output(const char *path, bool strict, output_t *o) {
+    FILE *f = fopen(path, "rb");
+    long size, capacity = 1024, run_start = -1, step = 0;
+    bool in_banner = false;
+
+    if (f == NULL) {
+        fprintf(stderr, "Error: cannot read %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    rewind(f);
+    o->text = checked_malloc(size + 1);
+    size = fread(o->text, 1, size, f);
+    o->text[size] = '\0';
+    fclose(f);
+
+    o->lines = checked_malloc(capacity * sizeof(char *));
+    o->step = checked_malloc(capacity * sizeof(long));
+    o->count = 0;
+    for (char *line = o->text, *next; *line != '\0'; line = next) {
+        next = strchr(line, '\n');
+        if (next != NULL)
+            *next++ = '\0';
+        else
+            next = line + strlen(line);
+
+        if (strncmp(line, "Error:", 6) == 0)
+            continue;
+        if (is_banner(line)) {
+            step += !in_banner;
+            in_banner = !in_banner;
+        }
+        else if (strncmp(line, "STEP ", 5) == 0) {
+            step++;
+        }
+
+        bool block = strncmp(line, "Block ", 6) == 0 && strchr(line, ':') != NULL;
+        if (!strict && run_start >= 0 && !block) {
+            qsort(o->lines + run_start, o->count - run_start, sizeof(char *), compare_lines);
+            run_start = -1;
+        }
+        if (!strict && block) {
+            line = strchr(line, ':') + 1;
+            if (run_start < 0)
+                run_start = o->count;
+        }
+
+        if (o->count == capacity) {
+            capacity *= 2;
+            o->lines = realloc(o->lines, capacity * sizeof(char *));
+            o->step = realloc(o->step, capacity * sizeof(long));
+            if (o->lines == NULL || o->step == NULL) {
+                fprintf(stderr, "Error: mmu_diff out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        o->lines[o->count] = line;
+        o->step[o->count++] = step;
+    }
+    if (run_start >= 0)
+        qsort(o->lines + run_start, o->count - run_start, sizeof(char *), compare_lines);
+}
+
+static void free_output(output_t *o) {
+    free(o->text);
+    free(o->lines);
+    free(o->step);
+}
+
+/* Returns the first step at which the outputs differ, or -1 if they match.
+ * *line is set to the index of the first differing line. */
+static long first_divergence(const output_t *a, const output_t *b, long *line) {
+    long n = a->count < b->count ? a->count : b->count;
+
+    for (long i = 0; i < n; i++) {
+        if (a->step[i] != b->step[i] || strcmp(a->lines[i], b->lines[i]) != 0) {
+            *line = i;
+            return a->step[i] < b->step[i] ? a->step[i] : b->step[i];
+        }
+    }
+    if (a->count == b->count)
+        return -1;
+    *line = n;
+    return a->count > n ? a->step[n] : b->step[n];
+}
+
+/* Describes a step by its operation, as it appears in the trace. */
+static void format_step(char *buf, size_t size, long step, int (*ops)[2]) {
+    if (step > 0)
+        snprintf(buf, size, "step %ld (%d %d)", step, ops[step - 1][0], ops[step - 1][1]);
+    else
+        snprintf(buf, size, "step 0");
+}
+
+/* Prints the first lines on which two outputs differ. */
+static void print_divergence(long line, const char *name_a, const output_t *a, const char *name_b,
+                             const output_t *b) {
+    printf("    %-8s %s\n", name_a, line < a->count ? a->lines[line] : "<end of output>");
+    printf("    %-8s %s\n", name_b, line < b->count ? b->lines[line] : "<end of output>");
+}
+
+/* Returns whether engine e may diverge from plain mmu under policy p at
+ * step, a choice between holes the two need not agree on. */
+static bool divergence_allowed(int p, int e, long step, int (*ops)[2]) {
+    if (!engines[e].exact)
+        return true;
+    if (!policies[p].ties)
+        return false;
+    if (!engines[e].exact_ties)
+        return true;
+    if (policies[p].coalesce_reorders) {
+        for (long i = 0; i < step; i++) {
+            if (ops[i][0] == -99999)
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function: failing_step
+ * ----------------------
+ * Bisects the trace for the shortest prefix on which a run of the reference
+ * fails, and returns its length: the step at which it crashed or hung. A
+ * crash loses whatever the reference had buffered, so its output cannot
+ * tell.
+ */
+static long failing_step(const diff_options_t *opts, const char *dir, const char *policy, int (*ops)[2],
+                         long count) {
+    char trace[4096], out[4096];
+    long lo = 0, hi = count;   // the prefix of lo operations runs, that of hi fails
+
+    snprintf(trace, sizeof(trace), "%s/prefix.txt", dir);
+    snprintf(out, sizeof(out), "%s/prefix.out", dir);
+    while (hi - lo > 1) {
+        long mid = lo + (hi - lo) / 2;
+        write_trace(trace, DIFF_PARTITION_SIZE, ops, mid);
+        if (run_binary(opts->ref, trace, policy, NULL, NULL, out, opts->timeout).status == RUN_OK)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    unlink(trace);
+    unlink(out);
+    return hi;
+}
+
+/* Returns whether plain mmu and the engine of flag hold the same blocks
+ * after the operations of trace, their lists sorted unless strict. */
+static bool same_final_layout(const diff_options_t *opts, const char *trace, const char *policy,
+                              const char *flag, const char *base_out, const char *mmu_out) {
+    run_t base = run_binary(opts->mmu, trace, policy, NULL, "-FINAL", base_out, opts->scale_timeout);
+    run_t run = run_binary(opts->mmu, trace, policy, flag, "-FINAL", mmu_out, opts->scale_timeout);
+    output_t expected, actual;
+    long line;
+    bool same;
+
+    if (base.status != RUN_OK || run.status != RUN_OK)
+        return false;
+    load_output(base_out, opts->strict, &expected);
+    load_output(mmu_out, opts->strict, &actual);
+    same = first_divergence(&expected, &actual, &line) < 0;
+    free_output(&expected);
+    free_output(&actual);
+    return same;
+}
+
+/**
+ * Function: diverging_step
+ * ------------------------
+ * Bisects the scaling trace for the shortest prefix after which plain mmu
+ * and the engine of flag hold different blocks, and returns its length.
+ *
+ * Description:
+ *  The -SUMMARY lines only count the free space, so two runs can place a
+ *  block differently some steps before the counts tell them apart: hi, the
+ *  step they did, is a prefix known to differ. Each probe compares the
+ *  -FINAL layouts, as failing_step does with the reference's exit status.
+ */
+static long diverging_step(const diff_options_t *opts, const char *dir, const char *policy, const char *flag,
+                           int (*ops)[2], long hi) {
+    char trace[4096], base_out[4096], mmu_out[4096];
+    long lo = 0;   // the prefix of lo operations leaves the same blocks, that of hi does not
+
+    snprintf(trace, sizeof(trace), "%s/prefix.txt", dir);
+    snprintf(base_out, sizeof(base_out), "%s/prefix_plain.out", dir);
+    snprintf(mmu_out, sizeof(mmu_out), "%s/prefix_engine.out", dir);
+    while (hi - lo > 1) {
+        long mid = lo + (hi - lo) / 2;
+        write_trace(trace, DIFF_SCALE_PARTITION_SIZE, ops, mid);
+        if (same_final_layout(opts, trace, policy, flag, base_out, mmu_out))
+            lo = mid;
+        else
+            hi = mid;
+    }
+    unlink(trace);
+    unlink(base_out);
+    unlink(mmu_out);
+    return hi;
+}
+
+/***** Driver ********/
+
+static void usage(void) {
+    printf("usage: ./mmu_diff [-TRACES n] [-OPS n] [-SEED s] [-REF file] [-MMU file] [-TIMEOUT s]\n");
+    printf("                  [-SCALE-TIMEOUT s] [-STRICT] [-KEEP]\n");
+    exit(1);
+}
+
+static void get_diff_options(int argc, char *argv[], diff_options_t *opts) {
+    opts->traces = 10;
+    opts->ops = 100000;
+    opts->seed = 1;
+    opts->ref = "./mmu_ref";
+    opts->mmu = "./mmu";
+    opts->timeout = 5;
+    opts->scale_timeout = 60;
+    opts->strict = false;
+    opts->keep = false;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+
+        if (strcasecmp(argv[i], "-TRACES") == 0 && has_value)
+            opts->traces = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-OPS") == 0 && has_value)
+            opts->ops = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-SEED") == 0 && has_value)
+            opts->seed = strtoul(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-REF") == 0 && has_value)
+            opts->ref = argv[++i];
+        else if (strcasecmp(argv[i], "-MMU") == 0 && has_value)
+            opts->mmu = argv[++i];
+        else if (strcasecmp(argv[i], "-TIMEOUT") == 0 && has_value)
+            opts->timeout = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-SCALE-TIMEOUT") == 0 && has_value)
+            opts->scale_timeout = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-STRICT") == 0)
+            opts->strict = true;
+        else if (strcasecmp(argv[i], "-KEEP") == 0)
+            opts->keep = true;
+        else
+            usage();
+    }
+
+    if (opts->traces < 0 || opts->ops < 0 || opts->timeout < 1 || opts->scale_timeout < 1)
+        usage();
+}
+
+/**
+ * Function: compare_with_ref
+ * --------------------------
+ * Replays opts->traces traces of DIFF_REF_MAX_OPS operations through
+ * mmu_ref and every engine of mmu. Returns the number of mismatches.
+ *
+ * Description:
+ *  Where mmu_ref fails the way its policy is known to, crashing or diverging
+ *  from plain mmu, the failure is counted as known and plain mmu's output is
+ *  what the other engines are held to. Any other failure of mmu_ref, a
+ *  failing mmu run and a divergence the engine does not allow count as
+ *  mismatches.
+ */
+static int compare_with_ref(const diff_options_t *opts, const char *dir) {
+    int (*ops)[2] = checked_malloc(DIFF_REF_MAX_OPS * sizeof(*ops));
+    int identical[NUM_POLICIES][NUM_ENGINES] = {{0}}, allowed[NUM_POLICIES][NUM_ENGINES] = {{0}};
+    int diverged[NUM_POLICIES][NUM_ENGINES] = {{0}}, ref_known[NUM_POLICIES] = {0}, ref_failed[NUM_POLICIES] = {0};
+    double ref_ms[NUM_POLICIES] = {0}, mmu_ms[NUM_POLICIES][NUM_ENGINES] = {{0}};
+    char trace[4096], ref_out[4096], mmu_out[4096];
+    int mismatches = 0;
+
+    printf("mmu_ref against mmu: %d traces of %d operations, seed %lu, partition %d\n\n", opts->traces,
+           DIFF_REF_MAX_OPS, opts->seed, DIFF_PARTITION_SIZE);
+    snprintf(ref_out, sizeof(ref_out), "%s/ref.out", dir);
+    snprintf(mmu_out, sizeof(mmu_out), "%s/mmu.out", dir);
+
+    for (int t = 0; t < opts->traces; t++) {
+        bool keep_trace = false;
+
+        rng_state = opts->seed * 0x9E3779B97F4A7C15ull + t + 1;  // never zero
+        gen_trace(ops, DIFF_REF_MAX_OPS, DIFF_LIVE_TARGET, DIFF_MAX_SIZE, DIFF_COALESCE_ODDS);
+        snprintf(trace, sizeof(trace), "%s/trace%d.txt", dir, t);
+        write_trace(trace, DIFF_PARTITION_SIZE, ops, DIFF_REF_MAX_OPS);
+
+        for (int p = 0; p < NUM_POLICIES; p++) {
+            run_t ref = run_binary(opts->ref, trace, policies[p].flag, NULL, NULL, ref_out, opts->timeout);
+            output_t expected;
+            const char *expected_name = "mmu_ref:";
+            bool have_expected = ref.status == RUN_OK;
+
+            ref_ms[p] += ref.ms;
+            if (!have_expected) {
+                bool known = policies[p].ref == REF_CRASHES;
+
+                printf("trace %d %s: mmu_ref ", t, policies[p].name);
+                print_failure(&ref);
+                printf(" at step %ld%s\n", failing_step(opts, dir, policies[p].flag, ops, DIFF_REF_MAX_OPS),
+                       known ? " (known)" : "");
+                if (!known) {
+                    ref_failed[p]++;
+                    mismatches++;
+                    keep_trace = true;
+                    continue;
+                }
+                ref_known[p]++;
+                expected_name = "plain:";
+            }
+            else {
+                load_output(ref_out, opts->strict, &expected);
+            }
+
+            for (int e = 0; e < NUM_ENGINES; e++) {
+                run_t run = run_binary(opts->mmu, trace, policies[p].flag, engines[e].flag, NULL, mmu_out,
+                                       opts->timeout);
+                output_t actual;
+                long step, line;
+                char where[64];
+
+                mmu_ms[p][e] += run.ms;
+                if (run.status != RUN_OK) {
+                    printf("trace %d %s %s: mmu ", t, policies[p].name, engines[e].name);
+                    print_failure(&run);
+                    printf("\n");
+                    diverged[p][e]++;
+                    mismatches++;
+                    keep_trace = true;
+                    continue;
+                }
+                load_output(mmu_out, opts->strict, &actual);
+                if (!have_expected) {   // plain mmu stands in for the reference
+                    expected = actual;
+                    have_expected = true;
+                    continue;
+                }
+                if ((step = first_divergence(&expected, &actual, &line)) < 0) {
+                    identical[p][e]++;
+                    free_output(&actual);
+                    continue;
+                }
+
+                format_step(where, sizeof(where), step, ops);
+                if (e == 0 && policies[p].ref == REF_WRONG) {
+                    printf("trace %d %s: mmu_ref diverges at %s (known)\n", t, policies[p].name, where);
+                    print_divergence(line, "mmu_ref:", &expected, "plain:", &actual);
+                    ref_known[p]++;
+                    free_output(&expected);
+                    expected = actual;
+                    expected_name = "plain:";
+                    continue;
+                }
+                if (divergence_allowed(p, e, step, ops)) {
+                    printf("trace %d %s %s: diverges at %s (allowed)\n", t, policies[p].name, engines[e].name,
+                           where);
+                    allowed[p][e]++;
+                }
+                else {
+                    printf("trace %d %s %s: diverges at %s\n", t, policies[p].name, engines[e].name, where);
+                    diverged[p][e]++;
+                    mismatches++;
+                    keep_trace = true;
+                }
+                print_divergence(line, expected_name, &expected, "mmu:", &actual);
+                free_output(&actual);
+            }
+            if (have_expected)
+                free_output(&expected);
+        }
+        if (!keep_trace && !opts->keep)
+            unlink(trace);
+    }
+    unlink(ref_out);
+    unlink(mmu_out);
+
+    printf("\n%-9s %-8s %9s %8s %8s %9s %10s %9s %9s\n", "policy", "engine", "identical", "allowed", "diverged",
+           "ref known", "ref failed", "ref ms", "mmu ms");
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        for (int e = 0; e < NUM_ENGINES; e++) {
+            printf("%-9s %-8s %9d %8d %8d %9d %10d %9.1f %9.1f\n", policies[p].name, engines[e].name,
+                   identical[p][e], allowed[p][e], diverged[p][e], ref_known[p], ref_failed[p], ref_ms[p],
+                   mmu_ms[p][e]);
+        }
+    }
+    free(ops);
+    return mismatches;
+}
+
+/**
+ * Function: compare_engines
+ * -------------------------
+ * Replays one trace of opts->ops operations through plain mmu and every
+ * engine, with -SUMMARY output to keep the printing out of the timings.
+ * Returns the number of mismatches.
+ *
+ * Description:
+ *  Where the summaries differ, diverging_step bisects for the step at which
+ *  the blocks first did. A divergence the engine allows is reported, but
+ *  not counted.
+ */
+static int compare_engines(const diff_options_t *opts, const char *dir) {
+    int (*ops)[2] = checked_malloc(opts->ops * sizeof(*ops));
+    char trace[4096], base_out[4096], mmu_out[4096];
+    int mismatches = 0;
+
+    printf("\nplain mmu against its engines: %ld operations, seed %lu, partition %d, summary output\n\n",
+           opts->ops, opts->seed, DIFF_SCALE_PARTITION_SIZE);
+    printf("%-9s %-8s %-26s %9s %9s %8s\n", "policy", "engine", "first divergence", "plain ms", "engine ms", "speedup");
+
+    rng_state = opts->seed * 0x9E3779B97F4A7C15ull;
+    gen_trace(ops, opts->ops, DIFF_SCALE_LIVE_TARGET, DIFF_SCALE_MAX_SIZE, DIFF_SCALE_COALESCE_ODDS);
+    snprintf(trace, sizeof(trace), "%s/scale.txt", dir);
+    snprintf(base_out, sizeof(base_out), "%s/plain.out", dir);
+    snprintf(mmu_out, sizeof(mmu_out), "%s/engine.out", dir);
+    write_trace(trace, DIFF_SCALE_PARTITION_SIZE, ops, opts->ops);
+
+    for (int p = 0; p < NUM_POLICIES; p++) {
+        run_t base = run_binary(opts->mmu, trace, policies[p].flag, NULL, "-SUMMARY", base_out,
+                                opts->scale_timeout);
+        output_t expected;
+
+        if (base.status != RUN_OK) {
+            printf("%-9s %-8s mmu ", policies[p].name, engines[0].name);
+            print_failure(&base);
+            printf("\n");
+            mismatches++;
+            continue;
+        }
+        load_output(base_out, opts->strict, &expected);
+
+        for (int e = 1; e < NUM_ENGINES; e++) {
+            run_t run = run_binary(opts->mmu, trace, policies[p].flag, engines[e].flag, "-SUMMARY", mmu_out,
+                                   opts->scale_timeout);
+            output_t actual;
+            long step, line;
+            char result[64];
+
+            printf("%-9s %-8s ", policies[p].name, engines[e].name);
+            if (run.status != RUN_OK) {
+                print_failure(&run);
+                printf("\n");
+                mismatches++;
+                continue;
+            }
+            load_output(mmu_out, opts->strict, &actual);
+            step = first_divergence(&expected, &actual, &line);
+            if (step > 0)
+                step = diverging_step(opts, dir, policies[p].flag, engines[e].flag, ops, step);
+            if (step < 0)
+                snprintf(result, sizeof(result), "identical");
+            else
+                format_step(result, sizeof(result), step, ops);
+            printf("%-26s %9.1f %9.1f %7.2fx%s\n", result, base.ms, run.ms, base.ms / run.ms,
+                   step >= 0 && divergence_allowed(p, e, step, ops) ? " (allowed)" : "");
+            if (step >= 0) {
+                print_divergence(line, "plain:", &expected, "engine:", &actual);
+                if (!divergence_allowed(p, e, step, ops))
+                    mismatches++;
+            }
+            free_output(&actual);
+        }
+        free_output(&expected);
+    }
+    unlink(base_out);
+    unlink(mmu_out);
+    if (mismatches == 0 && !opts->keep)
+        unlink(trace);
+    free(ops);
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    diff_options_t opts;
+    char dir[] = "/tmp/mmu_diff.XXXXXX";
+    int mismatches = 0;
+
+    get_diff_options(argc, argv, &opts);
+    if (access(opts.ref, X_OK) != 0 || access(opts.mmu, X_OK) != 0) {
+        fprintf(stderr, "Error: %s and %s have to be executable\n", opts.ref, opts.mmu);
+        exit(1);
+    }
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "Error: cannot create a directory for the traces\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (opts.traces > 0)
+        mismatches += compare_with_ref(&opts, dir);
+    if (opts.ops > 0)
+        mismatches += compare_engines(&opts, dir);
+
+    if (rmdir(dir) != 0)  // something was kept
+        printf("\ntraces kept in %s\n", dir);
+    printf("\n%d mismatches\n", mismatches);
+    return mismatches > 0;
+}
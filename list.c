@@ -7,28 +7,94 @@
 #include <stdlib.h>
 #include <string.h>
 #include "./Headers/list.h"
+#include "./Headers/avl.h"
+#include "./Headers/pidmap.h"
+#include "./Headers/pool.h"
+#include "./Headers/soa.h"
+#include "./Headers/tlsf.h"
+#include "./Headers/quick.h"
+
+/* Every list and block is carved from these pools; nodes live inside blocks. */
+static pool_t list_pool = POOL_INIT(sizeof(list_t));
+static pool_t block_pool = POOL_INIT(sizeof(block_t));
+
+/***** Helpers ********/
+
+/* Links node into the list just before next (at the back when next is NULL)
+ * and adds it to the list's indexes, if any. */
+static void list_link_before(list_t *list, node_t *node, node_t *next) {
+    node->next = next;
+    node->prev = (next != NULL) ? next->prev : list->tail;
+
+    if (node->prev != NULL)
+        node->prev->next = node;
+    else
+        list->head = node;
+
+    if (next != NULL)
+        next->prev = node;
+    else
+        list->tail = node;
+
+    list->length++;
+
+    if (list->size_index != NULL)
+        avl_insert(list->size_index, node);
+    if (list->addr_index != NULL)
+        avl_insert(list->addr_index, node);
+    if (list->pid_index != NULL)
+        pid_map_add(list->pid_index, node);
+}
+
+/* Unlinks node from the list and from its indexes; the node is not freed. */
+static void list_unlink(list_t *list, node_t *node) {
+    if (list->size_index != NULL)
+        avl_remove(list->size_index, node);
+    if (list->addr_index != NULL)
+        avl_remove(list->addr_index, node);
+    if (list->pid_index != NULL)
+        pid_map_remove(list->pid_index, node);
+    if (list->rover == node)
+        list->rover = node->next;
+
+    if (node->prev != NULL)
+        node->prev->next = node->next;
+    else
+        list->head = node->next;
+
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+    else
+        list->tail = node->prev;
+
+    node->next = node->prev = NULL;
+    list->length--;
+}
 
 /***** Function Definitions ********/
 
 /**
  * Function: list_alloc
  * --------------------
- * Allocates memory for a new list using malloc.
+ * Allocates memory for a new list from the list pool.
  *
  * Returns:
  *  A pointer to the newly allocated list. The list's head and tail are initialized to NULL, and its length is initialized to 0.
- *  If memory allocation fails, the function prints an error message and exits with a failure status.
+ *  If memory allocation fails, the pool prints an error message and exits with a failure status.
  */
 list_t *list_alloc() {
-  list_t *list = malloc(sizeof(list_t));
-  if (list == NULL) {
-    fprintf(stderr, "Error: list_alloc failed\n");
-    exit(EXIT_FAILURE);
-  }
+  list_t *list = pool_alloc(&list_pool);
 
   list->head = NULL;
   list->tail = NULL;
   list->length = 0;
+  list->size_index = NULL;
+  list->addr_index = NULL;
+  list->pid_index = NULL;
+  list->soa = NULL;
+  list->tlsf = NULL;
+  list->quick = NULL;
+  list->rover = NULL;
 
   return list;
 }
@@ -36,23 +102,19 @@ list_t *list_alloc() {
 /**
  * Function: node_alloc
  * --------------------
- * Allocates memory for a new node using malloc.
+ * Prepares the node embedded in a block for linking. Nothing is allocated.
  *
  * Parameters:
- *  blk: A pointer to a block that the node will contain.
+ *  blk: A pointer to a block that the node will contain. It must not be on a list.
  *
  * Returns:
- *  A pointer to the newly allocated node. The node's next pointer is initialized to NULL, and its blk pointer is set to the passed block.
- *  If memory allocation fails, the function prints an error message and exits with a failure status.
+ *  A pointer to the block's node. The node's next pointer is initialized to NULL, and its blk pointer is set to the passed block.
  */
 node_t *node_alloc(block_t *blk) {
-  node_t *node = malloc(sizeof(node_t));
-  if (node == NULL) {
-    fprintf(stderr, "Error: node_alloc failed\n");
-    exit(EXIT_FAILURE);
-  }
+  node_t *node = &blk->link;
 
   node->next = NULL;
+  node->prev = NULL;
   node->blk = blk;
   return node;
 }
@@ -60,22 +122,61 @@ node_t *node_alloc(block_t *blk) {
 /**
  * Function: node_free
  * -------------------
- * Frees the memory allocated for a node and its associated block.
+ * Frees the block a node is embedded in, which frees the node with it.
  *
  * Parameters:
  *  node: A pointer to the node to be freed.
  *
  * Note:
- *  If the node or its associated block is NULL, the function does nothing.
+ *  If the node is NULL, the function does nothing.
  */
 void node_free(node_t *node) {
   if (node != NULL) {
-    if (node->blk != NULL)
-      free(node->blk); // Free the associated block inside the node
-    free(node); // Free the node itself
+    block_free(node->blk); // Free the associated block, and the node inside it
   }
 }
 
+/**
+ * Function: block_alloc
+ * ---------------------
+ * Returns an uninitialized block from the block pool. Blocks handed to the
+ * list functions must come from here, since the list frees them to the pool.
+ */
+block_t *block_alloc() {
+  return pool_alloc(&block_pool);
+}
+
+/* Returns a block to the block pool. NULL is ignored. */
+void block_free(block_t *blk) {
+  pool_free(&block_pool, blk);
+}
+
+/**
+ * Function: list_release_all
+ * --------------------------
+ * Frees every list, node and block, and every list index, in one bulk
+ * release of their pools. All list_t pointers become invalid.
+ */
+void list_release_all() {
+  pid_map_release_all();
+  soa_release_all();
+  tlsf_release_all();
+  quick_release_all();
+  avl_release_all();
+  pool_release(&block_pool);
+  pool_release(&list_pool);
+}
+
+void list_mem_stats(mem_stats_t *stats) {
+  pool_mem_stats(&list_pool, stats);
+  pool_mem_stats(&block_pool, stats);
+  avl_mem_stats(stats);
+  pid_map_mem_stats(stats);
+  soa_mem_stats(stats);
+  tlsf_mem_stats(stats);
+  quick_mem_stats(stats);
+}
+
 /**
  * Function: list_free
  * -------------------
@@ -100,11 +201,33 @@ void list_free(list_t *list) {
     curr = next_node;
   }
 
-  free(list); //free the list itself
+  avl_free(list->size_index);
+  avl_free(list->addr_index);
+  pid_map_free(list->pid_index);
+  soa_free(list->soa);
+  tlsf_free(list->tlsf);
+  quick_free(list->quick);
+  pool_free(&list_pool, list); //free the list itself
 }
 
+/**
+ * Function: list_add_to_freelist
+ * ------------------------------
+ * Adds a free block to the free list in the order required by the policy.
+ *
+ * Description:
+ *  A size indexed free list places the block by its index in O(log n);
+ *  otherwise the block is inserted by a linear walk of the list. A packed
+ *  array store appends the block's start and size and frees the block.
+ */
 void list_add_to_freelist (list_t *freelist, block_t *block, int policy) {
-    if (policy == 1) {  // FIFO
+    if (freelist->soa != NULL) {
+        soa_push(freelist->soa, block->start, block->end);
+        block_free(block);
+        freelist->length++;
+    } else if (freelist->size_index != NULL) {
+        list_add_by_index(freelist, block);
+    } else if (policy == 1 || policy == 4) {  // FIFO, Next Fit
         list_add_to_back(freelist, block);
     } else if (policy == 2) {  // Best Fit
         list_add_ascending_by_blocksize(freelist, block);
@@ -113,25 +236,193 @@ void list_add_to_freelist (list_t *freelist, block_t *block, int policy) {
     }
 }
 
+/**
+ * Function: list_add_by_index
+ * ---------------------------
+ * Inserts a block into a size indexed list just before its successor in the
+ * index, so the list order always matches the index order.
+ */
+void list_add_by_index(list_t *list, block_t *blk) {
+    node_t *next = avl_successor(list->size_index, blk);
+    list_link_before(list, node_alloc(blk), next);
+}
+
+/**
+ * Function: list_index_by_size
+ * ----------------------------
+ * Attaches a block size index to the list and reorders the list to match it.
+ *
+ * Parameters:
+ *  list: A pointer to the (free) list to index.
+ *  policy: 2 orders by ascending size (best fit), 3 by descending size (worst fit),
+ *          5 by ascending size and then address (buddy).
+ */
+void list_index_by_size(list_t *list, int policy) {
+    block_t *blk;
+    list_t *temp_list;
+
+    if (list->size_index != NULL || (policy != 2 && policy != 3 && policy != 5))
+        return;
+
+    // Move the blocks aside, then re-add them through the new index
+    temp_list = list_alloc();
+    while ((blk = list_remove_from_front(list)) != NULL)
+        list_add_to_back(temp_list, blk);
+
+    // Equal sizes in the order the unindexed list keeps them, see avl_tie_t
+    if (policy == 2)
+        list->size_index = avl_alloc(avl_key_size, AVL_TIE_NEWEST_FIRST);
+    else if (policy == 5)
+        list->size_index = avl_alloc(avl_key_size, AVL_TIE_START);
+    else
+        list->size_index = avl_alloc(avl_key_size_desc, AVL_TIE_OLDEST_FIRST);
+
+    while ((blk = list_remove_from_front(temp_list)) != NULL)
+        list_add_by_index(list, blk);
+
+    list_free(temp_list);
+}
+
+/**
+ * Function: list_index_by_address
+ * -------------------------------
+ * Attaches a start address index to the list. The list order is unchanged.
+ */
+void list_index_by_address(list_t *list) {
+    if (list->addr_index != NULL)
+        return;
+
+    list->addr_index = avl_alloc(avl_key_start, AVL_TIE_START);
+    for (node_t *curr = list->head; curr != NULL; curr = curr->next)
+        avl_insert(list->addr_index, curr);
+}
+
+/**
+ * Function: list_index_by_pid
+ * ---------------------------
+ * Attaches a PID hash index to the list. The list order is unchanged.
+ */
+void list_index_by_pid(list_t *list) {
+    if (list->pid_index != NULL)
+        return;
+
+    list->pid_index = pid_map_alloc();
+    for (node_t *curr = list->head; curr != NULL; curr = curr->next)
+        pid_map_add(list->pid_index, curr);
+}
+
+/**
+ * Function: list_use_soa
+ * ----------------------
+ * Switches a free list to the packed array backend, keeping its order.
+ */
+void list_use_soa(list_t *list, int isa) {
+    block_t *blk;
+
+    if (list->soa != NULL)
+        return;
+
+    list->soa = soa_alloc((soa_isa_t)isa);
+    while ((blk = list_remove_from_front(list)) != NULL) {
+        soa_push(list->soa, blk->start, blk->end);
+        block_free(blk);
+    }
+    list->length = list->soa->count;
+}
+
+/**
+ * Function: list_use_tlsf
+ * -----------------------
+ * Moves the free blocks into a new TLSF engine, lowest address first.
+ */
+void list_use_tlsf(list_t *list) {
+    list_t *sorted;
+    block_t *blk;
+
+    if (list->tlsf != NULL || list->soa != NULL)
+        return;
+
+    sorted = list_alloc();
+    while ((blk = list_remove_from_front(list)) != NULL)
+        list_add_ascending_by_address(sorted, blk);
+
+    list->tlsf = tlsf_alloc();
+    while ((blk = list_remove_from_front(sorted)) != NULL) {
+        tlsf_add_range(list->tlsf, blk->start, blk->end);
+        block_free(blk);
+    }
+    list->length = list->tlsf->free_blocks;
+    list_free(sorted);
+}
+
+void list_use_quick(list_t *list, int policy) {
+    if (list->quick == NULL && list->tlsf == NULL)
+        list->quick = quick_alloc(policy);
+}
+
+/**
+ * Function: list_flush_quick
+ * --------------------------
+ * Adds every block cached in the quick lists back to the free list, using
+ * the policy the caches were created with.
+ */
+void list_flush_quick(list_t *list) {
+    if (list->quick == NULL)
+        return;
+
+    node_t *node = quick_take_all(list->quick);
+    while (node != NULL) {
+        node_t *next = node->next;
+        list_add_to_freelist(list, node->blk, list->quick->policy);
+        node = next;
+    }
+}
+
+/**
+ * Function: remove_block_from_freelist
+ * ------------------------------------
+ * Removes the free block with the same start and end as block, freeing both the
+ * node and the block stored in the list.
+ *
+ * Description:
+ *  An address indexed list finds the block in O(log n). A size index has
+ *  to search every hole of the block's size, as a copy of the block does
+ *  not carry its insertion stamp. Otherwise the list is walked from the
+ *  head.
+ */
 void remove_block_from_freelist(list_t *freelist, block_t *block) {
-    node_t *current = freelist->head;
-    node_t *prev = NULL;
-
-    while (current != NULL) {
-        if (current->blk->start == block->start && current->blk->end == block->end) {
-            if (prev) {
-                prev->next = current->next;
-            } else {
-                freelist->head = current->next;
-            }
-            free(current->blk);
-            free(current);
+    node_t *current;
+
+    if (freelist->soa != NULL) {
+        int i = soa_find_start(freelist->soa, block->start);
+        if (i >= 0 && freelist->soa->size[i] == block->end - block->start + 1) {
+            soa_remove(freelist->soa, i);
             freelist->length--;
-            return;
         }
-        prev = current;
-        current = current->next;
+        return;
+    }
+
+    if (freelist->addr_index != NULL) {
+        current = avl_find(freelist->addr_index, block);
+        if (current != NULL && current->blk->end != block->end)
+            current = NULL;
+    } else if (freelist->size_index != NULL) {
+        current = avl_find(freelist->size_index, block);
+    } else {
+        current = freelist->head;
+        while (current != NULL &&
+               !(current->blk->start == block->start && current->blk->end == block->end))
+            current = current->next;
     }
+
+    if (current != NULL) {
+        list_unlink(freelist, current);
+        node_free(current);
+    }
+}
+
+void list_remove_node(list_t *list, node_t *node) {
+    list_unlink(list, node); // the node lives in its block, so nothing is freed
 }
 
 /**
@@ -184,11 +475,17 @@ void list_coalese_nodes(list_t *list){
 
     while (curr != NULL && curr->next != NULL) {
         if (curr->blk->end + 1 == curr->next->blk->start) {
-            curr->blk->end = curr->next->blk->end;
             node_t *temp = curr->next;
-            curr->next = temp->next;
+            list_unlink(list, temp);
+
+            // An indexed block has to leave the index while its size changes
+            if (list->size_index != NULL)
+                avl_remove(list->size_index, curr);
+            curr->blk->end = temp->blk->end;
+            if (list->size_index != NULL)
+                avl_insert(list->size_index, curr);
+
             node_free(temp);
-            list->length--;
         }
         else {
             // Move to the next block if not adjacent
@@ -211,29 +508,12 @@ node_t* find_node_at_index(node_t* head, int index) {
 
 void list_add_to_back(list_t *list, block_t *blk) {
     node_t *new_node = node_alloc(blk);
-    if (list->head == NULL) { /* this is for the list being empty */
-        list->head = new_node;
-        list->tail = new_node; // Updating tail pointer to the end of list
-    }
-    else { /* this is for the list having at least one element */
-        list->tail->next = new_node;
-        list->tail = new_node; // Updating tail pointer to the end of list
-    }
-    list->length++; // Incrementing length of list
+    list_link_before(list, new_node, NULL); // Updates head/tail pointers and length of list
 }
 
 void list_add_to_front(list_t *list, block_t *blk) {
     node_t *new_node = node_alloc(blk);
-    node_t *curr = list->head;
-    if (curr == NULL) {
-        list->head = new_node;
-        list->tail = new_node; // Updating tail pointer to the end of list
-    }
-    else {
-        new_node->next = curr;
-        list->head = new_node;
-    }
-    list->length++; // Incrementing length of list
+    list_link_before(list, new_node, list->head); // Updates head/tail pointers and length of list
 }
 
 void list_add_at_index(list_t *list, block_t *blk, int index) {
@@ -250,14 +530,18 @@ void list_add_at_index(list_t *list, block_t *blk, int index) {
    else { // Index value is somewhere in the middle of the linked list
         node_t *new_node = node_alloc(blk);
         node_t *prev = find_node_at_index(list->head, index - 1); //Finding node before actual index value 
-        new_node->next = prev->next;
-        prev->next = new_node;
-        list->length++; // Incrementing length of list
+        list_link_before(list, new_node, prev->next);
    }
 
    //? what should be return if the index is below 0? 
 }
 
+/* Adds a block in front of next, a node on the list, or to the back if next
+ * is NULL. Keeps a block in place when it is taken off and put back. */
+void list_add_before(list_t *list, block_t *blk, node_t *next) {
+    list_link_before(list, node_alloc(blk), next);
+}
+
 /**
  * Function: list_add_ascending_by_address
  * ---------------------------------------
@@ -270,41 +554,27 @@ void list_add_at_index(list_t *list, block_t *blk, int index) {
  * Description:
  *  The function inserts the new block into the list while maintaining an order
  *  where blocks are sorted in ascending order based on their start addresses.
+ *  A list with an address index finds the position in O(log n).
  */
 void list_add_ascending_by_address(list_t *list, block_t *newblk) {
     // Allocate a new node for the block
     node_t *new_node = node_alloc(newblk);
 
-    // Handles the case where the list is initially empty
-    if (list->head == NULL) {
-        list->head = new_node; // The new node becomes the head
-        list->tail = new_node; // and also the tail of the list
-        list->length++;        // Increment the length of the list
-        return;                // Early return as the node is added
+    if (list->addr_index != NULL) {
+        list_link_before(list, new_node, avl_successor(list->addr_index, newblk));
+        return;
     }
 
     // Traverse the list to find the correct position for the new block
     node_t *curr = list->head; // Start from the head of the list
-    node_t *prev = NULL;       // Keep track of the previous node
 
     // Iterate until finding the position where the new block should be inserted
     while (curr != NULL && curr->blk->start < newblk->start) {
-        prev = curr;          // Move 'prev' to the current node
         curr = curr->next;    // Advance 'curr' to the next node
     }
 
-    // Insert the new node into the list at the found position
-    new_node->next = curr;    // The new node points to 'curr' node
-    if (prev) {
-        prev->next = new_node; // Insert after 'prev' node
-    }
-
-    // If inserting at the end, update the tail pointer
-    if (curr == NULL) {
-        list->tail = new_node;
-    }
-
-    list->length++; // Increment the length of the list
+    // Insert the new node before 'curr' (at the head, in the middle or at the end)
+    list_link_before(list, new_node, curr);
 }
 
 
@@ -327,37 +597,16 @@ void list_add_ascending_by_address(list_t *list, block_t *newblk) {
 void list_add_ascending_by_blocksize(list_t *list, block_t *newblk) {
     // Allocate a new node for the block
     node_t *new_node = node_alloc(newblk);
-    int newblk_size = newblk->end - newblk->start;
-    //? might need to include the +1 for the block size here
-
-    // If list is empty, add new node as both head and tail
-    if (list->head == NULL) {
-        list->head = list->tail = new_node;
-        list->length++;
-        return;
-    }
+    int newblk_size = newblk->end - newblk->start + 1;
 
     // Traverse the list to find the correct insertion point
     node_t *curr = list->head;
-    node_t *prev = NULL;
-    while (curr != NULL && (curr->blk->end - curr->blk->start) < newblk_size) {
-        prev = curr;
+    while (curr != NULL && (curr->blk->end - curr->blk->start + 1) < newblk_size) {
         curr = curr->next;
     }
 
-    // Insert new node in the list
-    new_node->next = curr;
-    if (prev) {
-        prev->next = new_node;
-    }
-
-    // If the new node is added at the end, update the tail
-    if (curr == NULL) {
-        list->tail = new_node;
-    }
-
-    // Increment list length
-    list->length++;
+    // Insert new node before 'curr'; this also updates head, tail and length
+    list_link_before(list, new_node, curr);
 }
 
 
@@ -378,38 +627,17 @@ void list_add_ascending_by_blocksize(list_t *list, block_t *newblk) {
  */
 void list_add_descending_by_blocksize(list_t *list, block_t *newblk) {
     node_t *new_node = node_alloc(newblk);
-    int newblk_size = newblk->end - newblk->start;
-
-    // If the list is empty, set the new node as both head and tail.
-    if (list->head == NULL) {
-        list->head = new_node;
-        list->tail = new_node;
-    } else {
-        node_t *curr = list->head;
-        node_t *prev = NULL;
-
-        // Iterate through the list to find the insertion point.
-        while (curr != NULL && (curr->blk->end - curr->blk->start + 1 ) >= newblk_size) {
-            prev = curr;
-            curr = curr->next;
-        }
-
-        // Insert the new node at the identified position.
-        new_node->next = curr;
-        if (prev == NULL) { // Inserting at the head.
-            list->head = new_node;
-        } else { // Inserting in the middle or end.
-            prev->next = new_node;
-        }
+    int newblk_size = newblk->end - newblk->start + 1;
+    node_t *curr = list->head;
 
-        // Update the tail if inserted at the end.
-        if (curr == NULL) {
-            list->tail = new_node;
-        }
+    // Iterate through the list to find the insertion point.
+    while (curr != NULL && (curr->blk->end - curr->blk->start + 1 ) >= newblk_size) {
+        curr = curr->next;
     }
 
-    // Increment the list length.
-    list->length++;
+    // Insert the new node at the identified position (head, middle or end);
+    // this also updates head, tail and the list length.
+    list_link_before(list, new_node, curr);
 }
 
 
@@ -421,12 +649,7 @@ block_t* list_remove_from_front(list_t *list) {
     }
     node_t *temp = list->head;
     block_t *removed_block = temp->blk;
-    list->head = list->head->next;
-    if (list->head == NULL) {
-        list->tail = NULL; // List became empty
-    }
-    free(temp); //Frees the node; not the block itself
-    list->length--; // Update length
+    list_remove_node(list, temp); //Unlinks the node; the block is kept
     return removed_block;
 }
 
@@ -435,16 +658,7 @@ block_t* list_remove_from_back(list_t *list) {
         return NULL; // List is empty
     }
     block_t *removed_block = list->tail->blk; // gets the block structure from the last node
-    if (list->head == list->tail) { // Only one node in the list
-        return list_remove_from_front(list);
-    }
-    else { //Assuming multiple nodes in the list
-        node_t *node_before_tail = find_node_at_index(list->head, list->length - 2); // Finding the node before the tail
-        free(list->tail);
-        list->tail = node_before_tail;
-        list->tail->next = NULL; // setting the next pointer to NULL
-    }
-    list->length--; // Update length
+    list_remove_node(list, list->tail); // the back link makes this O(1)
     return removed_block; // returning pointer to the block structure in the removed node
 }
 
@@ -462,12 +676,9 @@ block_t* list_remove_at_index(list_t *list, int index) {
         return list_remove_from_back(list);
    }
    else { // Index value is somewhere in the middle of the linked list
-        node_t *prev = find_node_at_index(list->head, index - 1); //Finding node before actual index value 
-        node_t *curr = prev->next;
+        node_t *curr = find_node_at_index(list->head, index); //Finding node at actual index value 
         block_t *removed_block = curr->blk;
-        prev->next = curr->next;
-        free(curr); //Frees the node; not the block itself
-        list->length--; // Update length
+        list_remove_node(list, curr); //Unlinks the node; the block is kept
         return removed_block; // returning pointer to the block structure in the removed node
    }
 }
@@ -520,6 +731,10 @@ bool list_is_in_by_size(list_t *list, int number) {
 }
 
 bool list_is_in_by_pid(list_t *list, int pid) {
+    if (list->pid_index != NULL) {
+        return pid_map_get(list->pid_index, pid) != NULL;
+    }
+
     node_t *curr = list->head;
     while (curr != NULL) {
         if (compare_pid(pid, curr->blk)) {
@@ -618,7 +833,7 @@ int list_get_index_of_by_Pid(list_t *list, int pid) {
     node_t *curr = list->head;
     int count = 0;
 
-    if (curr == NULL) {
+    if (curr == NULL || (list->pid_index != NULL && pid_map_get(list->pid_index, pid) == NULL)) {
         return -1;
     }
 
@@ -630,4 +845,61 @@ int list_get_index_of_by_Pid(list_t *list, int pid) {
         count++;
     }
     return -1;
-}
\ No newline at end of file
+}
+
+node_t* list_get_node_by_pid(list_t *list, int pid) {
+    if (list->pid_index != NULL) {
+        return pid_map_get(list->pid_index, pid);
+    }
+
+    node_t *curr = list->head;
+    while (curr != NULL && !compare_pid(pid, curr->blk)) {
+        curr = curr->next;
+    }
+    return curr;
+}
+
+/**
+ * Function: list_get_node_by_pid_at
+ * ---------------------------------
+ * Finds the node of the block held by pid that starts at start.
+ *
+ * Description:
+ *  With a PID index the block is looked up among the PID's own blocks in
+ *  O(log k); otherwise the whole list is scanned.
+ */
+node_t* list_get_node_by_pid_at(list_t *list, int pid, int start) {
+    if (list->pid_index != NULL)
+        return pid_map_get_at(list->pid_index, pid, start);
+
+    node_t *curr = list->head;
+    while (curr != NULL && (curr->blk->pid != pid || curr->blk->start != start)) {
+        curr = curr->next;
+    }
+    return curr;
+}
+
+/**
+ * Function: list_get_node_by_address
+ * ----------------------------------
+ * Finds the first block of an address ordered list that ends at or after addr.
+ *
+ * Description:
+ *  Blocks do not overlap, so with an address index the answer is either the
+ *  last block starting at or before addr, if it reaches addr, or the first one
+ *  starting after it. Without one the list is walked from the head.
+ */
+node_t* list_get_node_by_address(list_t *list, int addr) {
+    if (list->addr_index != NULL) {
+        node_t *floor = avl_floor(list->addr_index, addr);
+        if (floor != NULL && floor->blk->end >= addr)
+            return floor;
+        return avl_lower_bound(list->addr_index, addr + 1);
+    }
+
+    node_t *curr = list->head;
+    while (curr != NULL && curr->blk->end < addr) {
+        curr = curr->next;
+    }
+    return curr;
+}
@@ -0,0 +1,440 @@
+// listbench.c
+//
+// Microbenchmarks for the list.c primitives.
+//
+// Times each primitive on lists of 10 to 10^6 blocks and reports ns/op, its
+// growth from the previous length and the cache misses per op, so a
+// primitive that turns linear (or worse) shows up as a growth of 10 per
+// row. The blocks of a list are linked in an order unrelated to their place
+// in memory, as a free list's blocks are after some churn, so a walk pays
+// for pointer chasing. Misses are counted with perf_event_open when the
+// kernel allows it and otherwise estimated from the nodes each op visits.
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "./Headers/list.h"
+
+#define LIST_BENCH_MIN_LENGTH 10
+#define LIST_BENCH_MIN_OPS 4           // ops timed at least, however slow
+#define LIST_BENCH_SPACING 16          // address stride between the blocks of a list
+#define LIST_BENCH_MAX_SIZE 4096       // block sizes of the size ordered lists
+#define LIST_BENCH_BATCH_BLOCKS (1 << 21)  // blocks built up front for one coalesce batch
+#define LIST_BENCH_DEFAULT_L2 (1 << 20)    // cache size assumed if sysconf does not know
+
+typedef struct list_bench_options {
+  int max_length;
+  long min_ns;           // time each measurement runs for at least
+  unsigned long seed;
+  const char *csv_path;
+  const char *only;      // run just this primitive, or NULL
+} list_bench_options_t;
+
+/* State of one measurement: the list under test, a spare block the
+ * inserting primitives add and unlink again, and for coalescing a batch of
+ * lists built ahead of the timed region. */
+typedef struct bench_state {
+  list_t *list;
+  int length;
+  block_t *spare;
+  list_t **batch;
+} bench_state_t;
+
+typedef enum list_order {
+  ORDER_ADDRESS,         // ascending by address, blocks not adjacent
+  ORDER_SIZE_UP,         // ascending by size
+  ORDER_SIZE_DOWN,       // descending by size
+  ORDER_PAIRS            // ascending by address, every other block adjacent to the next
+} list_order_t;
+
+typedef struct primitive {
+  const char *name;
+  list_order_t order;
+  double visits;         // nodes one op walks past, as a fraction of the length
+  void (*run)(bench_state_t *st, long ops);
+  bool batched;          // each op consumes a list, see bench_state_t
+} primitive_t;
+
+/***** Random Numbers ********/
+
+static uint64_t rng_state;
+
+/* xorshift64* */
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static int rng_below(int n) {
+    return (int)(rng_next() % (uint64_t)n);
+}
+
+/***** Lists ********/
+
+/* Returns a list of length blocks in the given order. The blocks come from
+ * the pool in one run, and list position i goes to a random one of them, so
+ * walking the list jumps around memory. */
+static list_t *build_list(int length, list_order_t order) {
+    block_t **blocks = malloc(length * sizeof(block_t *));
+    list_t *list = list_alloc();
+
+    if (blocks == NULL) {
+        fprintf(stderr, "Error: list_bench out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < length; i++)
+        blocks[i] = block_alloc();
+    for (int i = length - 1; i > 0; i--) {  // Fisher-Yates
+        int j = rng_below(i + 1);
+        block_t *t = blocks[i];
+        blocks[i] = blocks[j];
+        blocks[j] = t;
+    }
+
+    for (int i = 0; i < length; i++) {
+        block_t *blk = blocks[i];
+        int size;
+
+        if (order == ORDER_SIZE_UP)
+            size = 1 + (int)((long)i * LIST_BENCH_MAX_SIZE / length);
+        else if (order == ORDER_SIZE_DOWN)
+            size = LIST_BENCH_MAX_SIZE - (int)((long)i * LIST_BENCH_MAX_SIZE / length);
+        else if (order == ORDER_PAIRS)
+            size = i % 2 == 0 ? LIST_BENCH_SPACING : LIST_BENCH_SPACING / 2;
+        else
+            size = LIST_BENCH_SPACING / 2;
+
+        // Blocks of the size ordered lists may overlap; only their order matters
+        blk->pid = 0;
+        blk->start = i * LIST_BENCH_SPACING;
+        blk->end = blk->start + size - 1;
+        list_add_to_back(list, blk);
+    }
+    free(blocks);
+    return list;
+}
+
+/***** Primitives ********/
+
+static volatile long sink;  // keeps the reads of list_get_elem_at_index alive
+
+/* The inserting primitives add the spare block and unlink it again in O(1),
+ * so the list keeps its length. */
+static void run_add_by_address(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++) {
+        st->spare->start = rng_below(st->length + 1) * LIST_BENCH_SPACING - LIST_BENCH_SPACING / 4;
+        st->spare->end = st->spare->start + 1;
+        list_add_ascending_by_address(st->list, st->spare);
+        list_remove_node(st->list, &st->spare->link);
+    }
+}
+
+static void run_add_by_size_up(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++) {
+        st->spare->end = st->spare->start + rng_below(LIST_BENCH_MAX_SIZE);
+        list_add_ascending_by_blocksize(st->list, st->spare);
+        list_remove_node(st->list, &st->spare->link);
+    }
+}
+
+static void run_add_by_size_down(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++) {
+        st->spare->end = st->spare->start + rng_below(LIST_BENCH_MAX_SIZE);
+        list_add_descending_by_blocksize(st->list, st->spare);
+        list_remove_node(st->list, &st->spare->link);
+    }
+}
+
+/* The removing primitives put the block back at the end of the list. */
+static void run_remove_from_back(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++)
+        list_add_to_back(st->list, list_remove_from_back(st->list));
+}
+
+static void run_remove_at_index(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++)
+        list_add_to_back(st->list, list_remove_at_index(st->list, rng_below(st->length)));
+}
+
+static void run_get_elem_at_index(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++)
+        sink += list_get_elem_at_index(st->list, rng_below(st->length))->start;
+}
+
+static void run_coalese_nodes(bench_state_t *st, long ops) {
+    for (long i = 0; i < ops; i++)
+        list_coalese_nodes(st->batch[i]);
+}
+
+/* remove_block_from_freelist frees the block it finds, so an equal one is
+ * allocated in its place. */
+static void run_remove_block(bench_state_t *st, long ops) {
+    block_t probe;
+
+    for (long i = 0; i < ops; i++) {
+        probe.start = rng_below(st->length) * LIST_BENCH_SPACING;
+        probe.end = probe.start + LIST_BENCH_SPACING / 2 - 1;
+        remove_block_from_freelist(st->list, &probe);
+
+        block_t *blk = block_alloc();
+        blk->pid = 0;
+        blk->start = probe.start;
+        blk->end = probe.end;
+        list_add_to_back(st->list, blk);
+    }
+}
+
+static const primitive_t primitives[] = {
+  {"list_add_ascending_by_address", ORDER_ADDRESS, 0.5, run_add_by_address, false},
+  {"list_add_ascending_by_blocksize", ORDER_SIZE_UP, 0.5, run_add_by_size_up, false},
+  {"list_add_descending_by_blocksize", ORDER_SIZE_DOWN, 0.5, run_add_by_size_down, false},
+  {"list_remove_from_back", ORDER_ADDRESS, 0.0, run_remove_from_back, false},
+  {"list_remove_at_index", ORDER_ADDRESS, 0.5, run_remove_at_index, false},
+  {"list_get_elem_at_index", ORDER_ADDRESS, 0.5, run_get_elem_at_index, false},
+  {"list_coalese_nodes", ORDER_PAIRS, 1.0, run_coalese_nodes, true},
+  {"remove_block_from_freelist", ORDER_ADDRESS, 0.5, run_remove_block, false},
+};
+
+#define NUM_PRIMITIVES ((int)(sizeof(primitives) / sizeof(primitives[0])))
+
+/***** Counters ********/
+
+static int perf_fd = -1;
+
+/* Opens a counter of last level cache misses in user space for this
+ * process. Returns false if the kernel or the machine does not offer one. */
+static bool perf_open(void) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    return perf_fd >= 0;
+}
+
+static void perf_start(void) {
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static long perf_stop(void) {
+    long long count = 0;
+
+    if (perf_fd >= 0) {
+        ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perf_fd, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+    }
+    return count;
+}
+
+/* The estimate is made against the L2 cache: it is private to the core, so
+ * its size is known, while a shared or virtualized L3 often is not. */
+static long l2_cache(void) {
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    return size > 0 ? size : LIST_BENCH_DEFAULT_L2;
+}
+
+/* Without a counter: each node an op walks past misses with the chance that
+ * a random block of the list is not cached, 1 - cache / list bytes. */
+static double estimate_misses(const primitive_t *prim, int length, long cache) {
+    double bytes = (double)length * sizeof(block_t);
+    double miss = bytes > cache ? 1.0 - cache / bytes : 0.0;
+    double visits = prim->visits * length;
+
+    return (visits > 1.0 ? visits : 1.0) * miss;
+}
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Runs one batch of a primitive, building and freeing the lists of a
+ * coalescing batch around the timed region. Returns its time in ns and adds
+ * the cache misses it counted to *misses. */
+static long run_batch(const primitive_t *prim, bench_state_t *st, long batch, long *misses) {
+    long start, elapsed;
+
+    if (prim->batched) {
+        st->batch = malloc(batch * sizeof(list_t *));
+        if (st->batch == NULL) {
+            fprintf(stderr, "Error: list_bench out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long i = 0; i < batch; i++)
+            st->batch[i] = build_list(st->length, prim->order);
+    }
+
+    perf_start();
+    start = now_ns();
+    prim->run(st, batch);
+    elapsed = now_ns() - start;
+    *misses += perf_stop();
+
+    if (prim->batched) {
+        for (long i = 0; i < batch; i++)
+            list_free(st->batch[i]);
+        free(st->batch);
+    }
+    return elapsed;
+}
+
+/**
+ * Function: measure
+ * -----------------
+ * Times a primitive on a list of length blocks.
+ *
+ * Description:
+ *  The primitive runs in batches that double until the timed regions add
+ *  up to min_ns and LIST_BENCH_MIN_OPS ops. Only the batches are timed and
+ *  counted, not the list setup; a coalescing batch is built beforehand,
+ *  since each call merges its list for good. One untimed batch runs first,
+ *  so the first timed one does not pay for cold caches and empty pools.
+ */
+static void measure(const primitive_t *prim, int length, long min_ns, long *ops, double *ns_per_op,
+                    double *misses_per_op) {
+    bench_state_t st = {NULL, length, NULL, NULL};
+    long batch = 1, total_ns = 0, total_misses = 0, warm_misses = 0;
+    long max_batch = prim->batched ? (LIST_BENCH_BATCH_BLOCKS / length > 1 ? LIST_BENCH_BATCH_BLOCKS / length : 1)
+                                   : 1L << 30;
+
+    *ops = 0;
+    if (!prim->batched) {
+        st.list = build_list(length, prim->order);
+        st.spare = block_alloc();
+        st.spare->pid = 0;
+        st.spare->start = 0;
+    }
+
+    run_batch(prim, &st, batch, &warm_misses);  // warm-up, not counted
+    while (total_ns < min_ns || *ops < LIST_BENCH_MIN_OPS) {
+        total_ns += run_batch(prim, &st, batch, &total_misses);
+        *ops += batch;
+        if (batch < max_batch)
+            batch *= 2;
+    }
+
+    *ns_per_op = (double)total_ns / *ops;
+    *misses_per_op = (double)total_misses / *ops;
+    list_release_all();  // the next measurement starts from empty pools
+}
+
+/***** Driver ********/
+
+static void usage(void) {
+    printf("usage: ./list_bench [-MAX n] [-TIME ms] [-SEED s] [-CSV file] [-PRIMITIVE name]\n");
+    printf("primitives:");
+    for (int i = 0; i < NUM_PRIMITIVES; i++)
+        printf(" %s", primitives[i].name);
+    printf("\n");
+    exit(1);
+}
+
+static void get_list_bench_options(int argc, char *argv[], list_bench_options_t *opts) {
+    opts->max_length = 1000000;
+    opts->min_ns = 20000000;
+    opts->seed = 1;
+    opts->csv_path = NULL;
+    opts->only = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+
+        if (strcasecmp(argv[i], "-MAX") == 0 && has_value)
+            opts->max_length = strtol(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-TIME") == 0 && has_value)
+            opts->min_ns = strtol(argv[++i], NULL, 10) * 1000000L;
+        else if (strcasecmp(argv[i], "-SEED") == 0 && has_value)
+            opts->seed = strtoul(argv[++i], NULL, 10);
+        else if (strcasecmp(argv[i], "-CSV") == 0 && has_value)
+            opts->csv_path = argv[++i];
+        else if (strcasecmp(argv[i], "-PRIMITIVE") == 0 && has_value)
+            opts->only = argv[++i];
+        else
+            usage();
+    }
+
+    if (opts->max_length < LIST_BENCH_MIN_LENGTH || opts->min_ns < 1)
+        usage();
+}
+
+int main(int argc, char *argv[])
+{
+    list_bench_options_t opts;
+    FILE *csv = NULL;
+    bool counted;
+    long cache = l2_cache();
+
+    get_list_bench_options(argc, argv, &opts);
+
+    if (opts.csv_path != NULL) {
+        csv = fopen(opts.csv_path, "w");
+        if (csv == NULL) {
+            fprintf(stderr, "Error: Invalid filepath\n");
+            exit(1);
+        }
+        fprintf(csv, "primitive,length,ops,ns_per_op,misses_per_op,misses_counted\n");
+    }
+
+    counted = perf_open();
+    printf("%ld ms per measurement, seed %lu, block %zu bytes, ", opts.min_ns / 1000000, opts.seed,
+           sizeof(block_t));
+    if (counted)
+        printf("cache misses counted by perf_event_open\n\n");
+    else
+        printf("L2 misses estimated (no perf_event_open) for a %ld KiB L2\n\n", cache / 1024);
+    printf("%-34s %8s %11s %12s %7s %11s\n", "primitive", "length", "ops", "ns/op", "growth",
+           counted ? "misses/op" : "~L2 miss/op");
+
+    for (int p = 0; p < NUM_PRIMITIVES; p++) {
+        double previous = 0.0;
+
+        if (opts.only != NULL && strcmp(opts.only, primitives[p].name) != 0)
+            continue;
+
+        for (long length = LIST_BENCH_MIN_LENGTH; length <= opts.max_length; length *= 10) {
+            long ops;
+            double ns, misses;
+
+            rng_state = opts.seed * 0x9E3779B97F4A7C15ull + p * 64 + length;  // never zero
+            measure(&primitives[p], length, opts.min_ns, &ops, &ns, &misses);
+            if (!counted)
+                misses = estimate_misses(&primitives[p], length, cache);
+
+            printf("%-34s %8ld %11ld %12.1f ", primitives[p].name, length, ops, ns);
+            if (previous > 0.0)
+                printf("%6.1fx", ns / previous);
+            else
+                printf("%7s", "-");
+            printf(" %11.2f\n", misses);
+            if (csv != NULL)
+                fprintf(csv, "%s,%ld,%ld,%.2f,%.4f,%d\n", primitives[p].name, length, ops, ns, misses, counted);
+            previous = ns;
+        }
+    }
+
+    if (csv != NULL)
+        fclose(csv);
+    if (perf_fd >= 0)
+        close(perf_fd);
+    return 0;
+}
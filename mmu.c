@@ -3,8 +3,37 @@
 #include <ctype.h>
 #include <string.h>
 #include "./Headers/list.h"
+#include "./Headers/avl.h"
+#include "./Headers/soa.h"
+#include "./Headers/buddy.h"
+#include "./Headers/tlsf.h"
+#include "./Headers/quick.h"
+#include "./Headers/paging.h"
+#include "./Headers/tlb.h"
+#include "./Headers/mmu.h"
 #include "./Headers/util.h"
 
+/**
+ * Function: usage
+ * ---------------
+ * Prints the command line usage and exits.
+ */
+static void usage(void) {
+    printf("usage: ./mmu <input file> -{F | B | W | N | U | T | G}  \n(F=FIFO | B=BESTFIT | W-WORSTFIT | N=NEXTFIT | U=BUDDY | T=TLSF | G=PAGING)\n");
+    printf("options: -I (size indexed free list; worst fit ties may differ after a coalesce)\n");
+    printf("         -E (eager coalescing) -K (quick lists)\n");
+    printf("         -C (compact allocated blocks on coalesce)\n");
+    printf("         -L (coalesce on allocation failure) -LAZY-LENGTH=N -LAZY-FRAG=P\n");
+    printf("         -BATCH=N (allocate consecutive requests together) -RELAXED\n");
+    printf("         -P (a free releases every block of the PID)\n");
+    printf("         -PAGE=N -LEVELS=N (page size and page table levels with -G)\n");
+    printf("         -OVERCOMMIT={LRU | CLOCK | ARC} (evict pages with -G once frames run out)\n");
+    printf("         -TLB=N -TLB-WAYS=N -TLB-POLICY={LRU | PLRU | RANDOM} -TLB-TAGS\n");
+    printf("         -S[OA][-SCALAR | -SSE | -AVX2] (packed array free list)\n");
+    printf("output:  -Q[UIET] | -EVERY=K | -FINAL | -SUMMARY\n");
+    exit(1);
+}
+
 /**
  * Function: TOUPPER
  * -----------------
@@ -26,31 +55,31 @@ void TOUPPER(char * arr){
 /**
  * Function: get_input
  * -------------------
- * Parses the input file and determines the memory allocation policy.
+ * Opens the input file and determines the memory allocation policy.
  *
  * Parameters:
  *  args: Command line arguments.
- *  input: Array to store the parsed data from the file.
- *  n: Pointer to store the number of data entries parsed.
+ *  trace: Pointer to store the reader the operations are streamed from.
  *  size: Pointer to store the size of the initial memory partition.
  *  policy: Pointer to store the chosen memory management policy.
  *
  * Description:
- *  Opens the specified input file, parses the data, and sets the memory management policy
- *  based on command line arguments. Supports 'FIFO', 'Best Fit', and 'Worst Fit' policies.
+ *  Opens the specified input file, reads the partition size, and sets the memory management policy
+ *  based on command line arguments. Supports 'FIFO', 'Best Fit', 'Worst Fit' and 'Next Fit' policies,
+ *  the binary buddy (see buddy.h) and TLSF (see tlsf.h) engines, and paging
+ *  (see paging.h).
+ *  The operations themselves are read one at a time with trace_next.
  */
-void get_input(char *args[], int input[][2], int *n, int *size, int *policy) 
+void get_input(char *args[], trace_reader_t **trace, int *size, int *policy) 
 {
-  	FILE *input_file = fopen(args[1], "r");
-	  if (!input_file) {
+    *trace = trace_open(args[1]);
+	  if (!*trace) {
 		    fprintf(stderr, "Error: Invalid filepath\n");
 		    fflush(stdout);
 		    exit(0);
 	  }
 
-    parse_file(input_file, input, n, size);
-  
-    fclose(input_file);
+    *size = (*trace)->partition_size;
   
     TOUPPER(args[2]);
   
@@ -60,34 +89,341 @@ void get_input(char *args[], int input[][2], int *n, int *size, int *policy)
         *policy = 2;
     else if((strcmp(args[2],"-W") == 0) || (strcmp(args[2],"-WORSTFIT") == 0))
         *policy = 3;
+    else if((strcmp(args[2],"-N") == 0) || (strcmp(args[2],"-NEXTFIT") == 0))
+        *policy = 4;
+    else if((strcmp(args[2],"-U") == 0) || (strcmp(args[2],"-BUDDY") == 0))
+        *policy = 5;
+    else if((strcmp(args[2],"-T") == 0) || (strcmp(args[2],"-TLSF") == 0))
+        *policy = 6;
+    else if((strcmp(args[2],"-G") == 0) || (strcmp(args[2],"-PAGING") == 0))
+        *policy = 7;
     else {
-       printf("usage: ./mmu <input file> -{F | B | W }  \n(F=FIFO | B=BESTFIT | W-WORSTFIT)\n");
-       exit(1);
+       usage();
     }
         
 }
 
 /**
- * Function: allocate_memory
- * -------------------------
- * Allocates memory blocks based on the specified policy.
+ * Function: get_options
+ * ---------------------
+ * Parses the optional flags that follow the policy argument.
  *
  * Parameters:
- *  freelist: Pointer to the list of free memory blocks.
- *  alloclist: Pointer to the list of allocated memory blocks.
- *  pid: Process ID requesting memory allocation.
- *  blocksize: Size of the memory block to allocate.
- *  policy: Memory management policy to use for allocation.
+ *  argc: Argument count.
+ *  args: Command line arguments.
+ *  opts: Pointer to the options to fill in.
  *
  * Description:
- *  Allocates a block of memory for the specified process ID according to the chosen policy.
- *  Supports 'First Fit', 'Best Fit', and 'Worst Fit' allocation strategies.
+ *  Every option is off unless its flag is given, so a plain
+ *  `./mmu <input file> -{F | B | W}` run behaves as before. Supported flags:
+ *   -I / -INDEXED   keep FREE_LIST in a block size index (best and worst fit).
+ *   -E / -EAGER     index FREE_LIST by address and merge free neighbours on
+ *                   every deallocation.
+ *   -S / -SOA       keep FREE_LIST in packed arrays searched by the widest
+ *                   SIMD kernels the CPU supports; -SOA-SCALAR, -SOA-SSE and
+ *                   -SOA-AVX2 cap the instruction set. Cannot be combined
+ *                   with -I or -E.
+ *   -K / -QUICK     cache freed blocks of up to QUICK_MAX_SIZE bytes by
+ *                   exact size and serve requests of that size from them.
+ *   -C / -COMPACT   make the coalesce operation slide allocated blocks
+ *                   together into one free region and report the bytes moved.
+ *   -L / -LAZY      when an allocation fails, coalesce FREE_LIST and retry.
+ *   -LAZY-LENGTH=N  with -L, also coalesce before an allocation once
+ *                   FREE_LIST holds N blocks (implies -L).
+ *   -LAZY-FRAG=P    with -L, also coalesce before an allocation once the
+ *                   free memory outside the largest hole reaches P% (implies
+ *                   -L; costs a free list walk per allocation after a free).
+ *   -BATCH=N        hand up to N consecutive allocate ops to
+ *                   allocate_memory_batch at once; they are printed as one
+ *                   step. Cannot be combined with -L.
+ *   -RELAXED        with -BATCH, let a batch be served out of order.
+ *   -P / -PIDFREE   make "-pid 0" release every block the PID holds instead
+ *                   of only its lowest addressed one.
+ *   -PAGE=N         the page and frame size in bytes of -G and of the TLB
+ *                   (default 64).
+ *   -LEVELS=N       with -G, the number of page table levels, 1 to
+ *                   PAGING_MAX_LEVELS (default 2).
+ *   -OVERCOMMIT=P   with -G, map pages beyond the free frames and evict
+ *                   resident ones to a backing store by policy P: LRU, CLOCK
+ *                   or ARC. Access ops fault evicted pages back in.
+ *   -TLB=N          cache the translations of access ops in an N entry TLB
+ *                   and report its hits, misses and flushes per PID.
+ *   -TLB-WAYS=N     its associativity (default 4, at most N).
+ *   -TLB-POLICY=P   its replacement policy: LRU (default), PLRU or RANDOM.
+ *   -TLB-TAGS       tag its entries with the PID instead of flushing it
+ *                   whenever another PID accesses memory.
+ *   -Q / -QUIET     print nothing per operation.
+ *   -EVERY=K        print both lists after every K-th operation only.
+ *   -FINAL          print both lists once, after the last operation.
+ *   -SUMMARY        print one line per operation with the free bytes, the
+ *                   number of holes and the largest hole.
+ *  The output flags replace each other; the last one given wins.
  */
-void allocate_memory(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy) {
+void get_options(int argc, char *args[], mmu_options_t *opts)
+{
+    opts->indexed = false;
+    opts->eager_coalesce = false;
+    opts->soa = false;
+    opts->soa_isa = soa_best_isa();
+    opts->quick = false;
+    opts->compact = false;
+    opts->lazy = false;
+    opts->lazy_length = 0;
+    opts->lazy_frag = 0;
+    opts->batch = 0;
+    opts->relaxed = false;
+    opts->pid_free = false;
+    opts->page_size = 64;
+    opts->levels = 2;
+    opts->replace = -1;
+    opts->tlb_entries = 0;
+    opts->tlb_ways = 4;
+    opts->tlb_policy = TLB_LRU;
+    opts->tlb_tags = false;
+    opts->output = OUTPUT_FULL;
+    opts->output_every = 1;
+
+    for (int i = 3; i < argc; i++) {
+        TOUPPER(args[i]);
+
+        if ((strcmp(args[i], "-I") == 0) || (strcmp(args[i], "-INDEXED") == 0))
+            opts->indexed = true;
+        else if ((strcmp(args[i], "-E") == 0) || (strcmp(args[i], "-EAGER") == 0))
+            opts->eager_coalesce = true;
+        else if ((strcmp(args[i], "-K") == 0) || (strcmp(args[i], "-QUICK") == 0))
+            opts->quick = true;
+        else if ((strcmp(args[i], "-C") == 0) || (strcmp(args[i], "-COMPACT") == 0))
+            opts->compact = true;
+        else if ((strcmp(args[i], "-L") == 0) || (strcmp(args[i], "-LAZY") == 0))
+            opts->lazy = true;
+        else if (strncmp(args[i], "-LAZY-LENGTH=", 13) == 0) {
+            char *end;
+            opts->lazy = true;
+            opts->lazy_length = strtol(args[i] + 13, &end, 10);
+            if (end == args[i] + 13 || *end != '\0' || opts->lazy_length < 2)
+                usage();
+        }
+        else if (strncmp(args[i], "-BATCH=", 7) == 0) {
+            char *end;
+            opts->batch = strtol(args[i] + 7, &end, 10);
+            if (end == args[i] + 7 || *end != '\0' || opts->batch < 2)
+                usage();
+        }
+        else if (strcmp(args[i], "-RELAXED") == 0)
+            opts->relaxed = true;
+        else if (strcmp(args[i], "-P") == 0 || strcmp(args[i], "-PIDFREE") == 0)
+            opts->pid_free = true;
+        else if (strncmp(args[i], "-PAGE=", 6) == 0) {
+            char *end;
+            opts->page_size = strtol(args[i] + 6, &end, 10);
+            if (end == args[i] + 6 || *end != '\0' || opts->page_size < 1)
+                usage();
+        }
+        else if (strncmp(args[i], "-TLB=", 5) == 0) {
+            char *end;
+            opts->tlb_entries = strtol(args[i] + 5, &end, 10);
+            if (end == args[i] + 5 || *end != '\0' || opts->tlb_entries < 1)
+                usage();
+        }
+        else if (strncmp(args[i], "-TLB-WAYS=", 10) == 0) {
+            char *end;
+            opts->tlb_ways = strtol(args[i] + 10, &end, 10);
+            if (end == args[i] + 10 || *end != '\0' || opts->tlb_ways < 1)
+                usage();
+        }
+        else if (strcmp(args[i], "-TLB-POLICY=LRU") == 0)
+            opts->tlb_policy = TLB_LRU;
+        else if (strcmp(args[i], "-TLB-POLICY=PLRU") == 0)
+            opts->tlb_policy = TLB_PLRU;
+        else if (strcmp(args[i], "-TLB-POLICY=RANDOM") == 0)
+            opts->tlb_policy = TLB_RANDOM;
+        else if (strcmp(args[i], "-TLB-TAGS") == 0)
+            opts->tlb_tags = true;
+        else if (strcmp(args[i], "-OVERCOMMIT=LRU") == 0)
+            opts->replace = REPLACE_LRU;
+        else if (strcmp(args[i], "-OVERCOMMIT=CLOCK") == 0)
+            opts->replace = REPLACE_CLOCK;
+        else if (strcmp(args[i], "-OVERCOMMIT=ARC") == 0)
+            opts->replace = REPLACE_ARC;
+        else if (strncmp(args[i], "-LEVELS=", 8) == 0) {
+            char *end;
+            opts->levels = strtol(args[i] + 8, &end, 10);
+            if (end == args[i] + 8 || *end != '\0' || opts->levels < 1 || opts->levels > PAGING_MAX_LEVELS)
+                usage();
+        }
+        else if (strncmp(args[i], "-LAZY-FRAG=", 11) == 0) {
+            char *end;
+            opts->lazy = true;
+            opts->lazy_frag = strtol(args[i] + 11, &end, 10);
+            if (end == args[i] + 11 || *end != '\0' || opts->lazy_frag < 1 || opts->lazy_frag > 99)
+                usage();
+        }
+        else if ((strcmp(args[i], "-S") == 0) || (strcmp(args[i], "-SOA") == 0))
+            opts->soa = true;
+        else if (strcmp(args[i], "-SOA-SCALAR") == 0) {
+            opts->soa = true;
+            opts->soa_isa = SOA_SCALAR;
+        }
+        else if (strcmp(args[i], "-SOA-SSE") == 0) {
+            opts->soa = true;
+            opts->soa_isa = SOA_SSE;
+        }
+        else if (strcmp(args[i], "-SOA-AVX2") == 0) {
+            opts->soa = true;
+            opts->soa_isa = SOA_AVX2;
+        }
+        else if ((strcmp(args[i], "-Q") == 0) || (strcmp(args[i], "-QUIET") == 0))
+            opts->output = OUTPUT_QUIET;
+        else if (strcmp(args[i], "-FINAL") == 0)
+            opts->output = OUTPUT_FINAL;
+        else if (strcmp(args[i], "-SUMMARY") == 0)
+            opts->output = OUTPUT_SUMMARY;
+        else if (strncmp(args[i], "-EVERY=", 7) == 0) {
+            char *end;
+            opts->output = OUTPUT_EVERY;
+            opts->output_every = strtol(args[i] + 7, &end, 10);
+            if (end == args[i] + 7 || *end != '\0' || opts->output_every < 1)
+                usage();
+        }
+        else
+            usage();
+    }
+
+    if (opts->soa && (opts->indexed || opts->eager_coalesce))
+        usage();
+    if ((opts->relaxed && opts->batch == 0) || (opts->batch > 0 && opts->lazy))
+        usage();
+}
+
+/**
+ * Function: allocate_from_store
+ * -----------------------------
+ * allocate_memory for a free list kept in a packed array store.
+ *
+ * Description:
+ *  The chosen entry is removed and its remainder appended, which keeps the
+ *  store in the same order as a FIFO free list would be.
+ */
+static block_t *allocate_from_store(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy) {
+    soa_store_t *store = freelist->soa;
+    int i = soa_find_fit(store, blocksize, policy);
+
+    if (i < 0)
+        return NULL;
+
+    block_t *new_block = block_alloc();
+    new_block->pid = pid;
+    new_block->start = store->start[i];
+    new_block->end = new_block->start + blocksize - 1;
+    list_add_ascending_by_address(alloclist, new_block);
+
+    if (policy == 4) { // Next Fit: the remainder stays where the search ended
+        store->start[i] += blocksize;
+        store->size[i] -= blocksize;
+        store->rover = i;
+        if (store->size[i] == 0) {
+            soa_remove(store, i);
+            freelist->length--;
+        }
+        return new_block;
+    }
+
+    int fragment_end = store->start[i] + store->size[i] - 1;
+    soa_remove(store, i);
+    freelist->length--;
+
+    if (new_block->end < fragment_end) {
+        soa_push(store, new_block->end + 1, fragment_end);
+        freelist->length++;
+    }
+    return new_block;
+}
+
+/**
+ * Function: allocate_from_tlsf
+ * ----------------------------
+ * allocate_memory for a free list handed to a TLSF engine. The allocated
+ * block is tagged with its engine header for deallocate_memory.
+ */
+static block_t *allocate_from_tlsf(list_t *freelist, list_t *alloclist, int pid, int blocksize) {
+    int h = tlsf_take(freelist->tlsf, blocksize);
+
+    if (h < 0)
+        return NULL;
+
+    block_t *new_block = block_alloc();
+    new_block->pid = pid;
+    new_block->start = freelist->tlsf->hdr[h].start;
+    new_block->end = new_block->start + freelist->tlsf->hdr[h].size - 1;
+    new_block->tag = h;
+    list_add_ascending_by_address(alloclist, new_block);
+    freelist->length = freelist->tlsf->free_blocks;
+    return new_block;
+}
+
+/**
+ * Function: next_fit
+ * ------------------
+ * Finds the first block that can hold blocksize, scanning from the list's
+ * rover to the tail and then wrapping around from the head.
+ *
+ * Returns:
+ *  The node of the block, or NULL if no block is large enough.
+ */
+static node_t *next_fit(list_t *freelist, int blocksize) {
+    node_t *start = freelist->rover != NULL ? freelist->rover : freelist->head;
+    node_t *current = start;
+
+    while (current != NULL) {
+        if (current->blk->end - current->blk->start + 1 >= blocksize)
+            return current;
+        current = current->next != NULL ? current->next : freelist->head;
+        if (current == start)
+            break;
+    }
+    return NULL;
+}
+
+/* Serves one request from the quick lists or the free list by the policy.
+ * Returns NULL, changing nothing, if neither has a block that can hold it. */
+static block_t *allocate_by_policy(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy) {
     node_t *current = freelist->head;
     node_t *best_fit = NULL;
     node_t *worst_fit = NULL;
 
+    if (policy == 5)  // Buddy engine
+        return buddy_allocate(freelist, alloclist, pid, blocksize);
+
+    if (freelist->quick != NULL) {
+        block_t *cached = quick_pop(freelist->quick, blocksize);
+        if (cached != NULL) {  // exact size, no search and no split
+            cached->pid = pid;
+            list_add_ascending_by_address(alloclist, cached);
+            return cached;
+        }
+    }
+
+    if (freelist->soa != NULL)
+        return allocate_from_store(freelist, alloclist, pid, blocksize, policy);
+
+    if (freelist->tlsf != NULL)
+        return allocate_from_tlsf(freelist, alloclist, pid, blocksize);
+
+    if (freelist->size_index != NULL && policy == 2) {
+        best_fit = avl_lower_bound(freelist->size_index, blocksize);
+        current = NULL; // no scan needed
+    }
+    else if (freelist->size_index != NULL && policy == 3) {
+        worst_fit = avl_first(freelist->size_index);
+        if (worst_fit && worst_fit->blk->end - worst_fit->blk->start + 1 < blocksize)
+            worst_fit = NULL;
+        current = NULL; // no scan needed
+    }
+    else if (policy == 4) {
+        best_fit = next_fit(freelist, blocksize);
+        current = NULL; // scanned from the rover instead
+    }
+
     // Iterate through the free list to find a suitable block
     while (current != NULL) {
         int current_size = current->blk->end - current->blk->start + 1;
@@ -112,29 +448,338 @@ void allocate_memory(list_t *freelist, list_t *alloclist, int pid, int blocksize
 
     if (selected_block) {
         // Allocate the block
-        block_t *new_block = malloc(sizeof(block_t));
+        block_t *new_block = block_alloc();
         *new_block = *(selected_block->blk);  // Copy block data
         new_block->pid = pid;
         new_block->end = new_block->start + blocksize - 1;
 
         list_add_ascending_by_address(alloclist, new_block);
 
-        // Handle the remaining memory (fragment)
-        if (new_block->end < selected_block->blk->end) {
-            block_t *fragment = malloc(sizeof(block_t));
-            fragment->pid = 0;  // Free block
-            fragment->start = selected_block->blk->start = new_block->end + 1;
-            fragment->end = selected_block->blk->end;
-            list_add_to_freelist(freelist, fragment, policy);  // Add back to free list
+        // Take the original block off the free list before it changes, so an
+        // indexed free list is never left holding a stale key
+        block_t *fragment = selected_block->blk;
+        node_t *next = selected_block->next;
+        list_remove_node(freelist, selected_block);  // a rover on it moves on to next
+
+        // Handle the remaining memory (fragment); the free block's record is reused for it
+        if (new_block->end < fragment->end) {
+            fragment->start = new_block->end + 1;
+            if (policy == 4) {  // Next Fit: keep the fragment in place and resume there
+                list_add_before(freelist, fragment, next);
+                freelist->rover = &fragment->link;
+            }
+            else {
+                list_add_to_freelist(freelist, fragment, policy);  // Add back to free list
+            }
         }
+        else {
+            block_free(fragment);
+            if (policy == 4)
+                freelist->rover = next;  // Next Fit: resume after the block used up
+        }
+        return new_block;
+    }
+    return NULL; // no suitable block is found
+}
 
-        // Remove the original block from the free list
-        remove_block_from_freelist(freelist, selected_block->blk);
+/**
+ * Function: try_allocate
+ * ----------------------
+ * allocate_memory without the error report. Returns the allocated block, or
+ * NULL if no free block can hold the request, leaving both lists unchanged.
+ *
+ * Description:
+ *  Blocks parked in the quick lists are free memory the policy search does
+ *  not see, so when the search fails they are flushed back to the free list
+ *  and the search is tried once more.
+ */
+static block_t *try_allocate(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy) {
+    block_t *blk = allocate_by_policy(freelist, alloclist, pid, blocksize, policy);
 
-    } else {
+    if (blk == NULL && freelist->quick != NULL && freelist->quick->cached > 0) {
+        list_flush_quick(freelist);
+        blk = allocate_by_policy(freelist, alloclist, pid, blocksize, policy);
+    }
+    return blk;
+}
+
+/**
+ * Function: allocate_memory
+ * -------------------------
+ * Allocates memory blocks based on the specified policy.
+ *
+ * Parameters:
+ *  freelist: Pointer to the list of free memory blocks.
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  pid: Process ID requesting memory allocation.
+ *  blocksize: Size of the memory block to allocate.
+ *  policy: Memory management policy to use for allocation.
+ *
+ * Description:
+ *  Allocates a block of memory for the specified process ID according to the chosen policy.
+ *  Supports 'First Fit', 'Best Fit', 'Worst Fit' and 'Next Fit' allocation strategies.
+ *  Next fit resumes the search at the free list's rover, and the remainder of
+ *  the block it splits stays in place with the rover pointing at it.
+ *  With quick lists, a request of a cached size is served from them in O(1).
+ *  When the free list carries a size index, best fit is a lower bound lookup and
+ *  worst fit takes the largest block, both in O(log n). A packed array free list
+ *  is searched by the store's SIMD kernels instead.
+ */
+void allocate_memory(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy) {
+    if (try_allocate(freelist, alloclist, pid, blocksize, policy) == NULL)
         fprintf(stderr, "Error: Not Enough Memory for PID %d\n", pid);
-        return; // Early return if no suitable block is found
+}
+
+/* Request order of a relaxed batch: largest first, ties in arrival order.
+ * qsort takes no context, so the batch being sorted is passed through here. */
+static const alloc_request_t *batch_reqs;
+
+static int compare_batch_order(const void *a, const void *b) {
+    int i = *(const int *)a, j = *(const int *)b;
+
+    if (batch_reqs[i].size != batch_reqs[j].size)
+        return batch_reqs[i].size > batch_reqs[j].size ? -1 : 1;
+    return i - j;
+}
+
+/* Returns the first position at or after i whose request is still pending.
+ * taken[i] is i itself while request order[i] is pending and points further
+ * along once it is served; paths are halved as they are followed. */
+static int next_pending(int *taken, int i) {
+    while (taken[i] != i) {
+        taken[i] = taken[taken[i]];
+        i = taken[i];
     }
+    return i;
+}
+
+/* Returns the pending position of the largest request that fits in room,
+ * or count if there is none. */
+static int largest_pending_fit(alloc_request_t *reqs, int *order, int *taken, int count, int room) {
+    int lo = 0, hi = count;
+
+    while (lo < hi) {  // first position whose size is <= room
+        int mid = (lo + hi) / 2;
+        if (reqs[order[mid]].size > room)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return next_pending(taken, lo);
+}
+
+/**
+ * Function: allocate_relaxed
+ * --------------------------
+ * allocate_memory_batch for a list free list in relaxed mode. Requests with
+ * a start of -1 are pending; the others were served already and are skipped.
+ *
+ * Description:
+ *  The free list is walked once in its own order, from the rover for next
+ *  fit. Each block is filled from its start with the largest pending requests
+ *  that still fit, so a best fit list, kept ascending by size, gets tight
+ *  fits, and a worst fit list packs its largest blocks first. Filled blocks
+ *  are taken off the list during the walk and their remainders put back
+ *  afterwards, next fit remainders staying in place. The requests are looked
+ *  up in size order, so the whole batch costs O((n + m) log m) for n free
+ *  blocks and m requests.
+ */
+static int allocate_relaxed(list_t *freelist, list_t *alloclist, alloc_request_t *reqs, int count, int policy) {
+    int *order = malloc(count * sizeof(int));
+    int *taken = malloc((count + 1) * sizeof(int));
+    list_t *fragments = list_alloc();
+    int allocated = 0, pending = 0, blocks = freelist->length;
+    node_t *curr = policy == 4 && freelist->rover != NULL ? freelist->rover : freelist->head;
+    block_t *blk;
+
+    if (order == NULL || taken == NULL) {
+        fprintf(stderr, "Error: out of memory for an allocation batch\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++)
+        order[i] = i;
+    batch_reqs = reqs;
+    qsort(order, count, sizeof(int), compare_batch_order);
+    for (int p = 0; p < count; p++) {
+        taken[p] = reqs[order[p]].start < 0 ? p : p + 1;
+        pending += reqs[order[p]].start < 0;
+    }
+    taken[count] = count;
+
+    for (int visited = 0; curr != NULL && visited < blocks && allocated < pending; visited++) {
+        node_t *next = curr->next != NULL || policy != 4 ? curr->next : freelist->head;
+        node_t *after = curr->next;
+        int p = largest_pending_fit(reqs, order, taken, count, curr->blk->end - curr->blk->start + 1);
+
+        if (p < count) {
+            blk = curr->blk;
+            list_remove_node(freelist, curr);
+            while (p < count) {
+                alloc_request_t *req = &reqs[order[p]];
+                block_t *new_block = block_alloc();
+                new_block->pid = req->pid;
+                new_block->start = blk->start;
+                new_block->end = blk->start + req->size - 1;
+                list_add_ascending_by_address(alloclist, new_block);
+
+                req->start = new_block->start;
+                blk->start += req->size;
+                taken[p] = p + 1;
+                allocated++;
+                p = largest_pending_fit(reqs, order, taken, count, blk->end - blk->start + 1);
+            }
+
+            if (blk->start > blk->end) {
+                block_free(blk);
+                if (policy == 4)
+                    freelist->rover = after;
+            }
+            else if (policy == 4) {  // Next Fit: the remainder stays in place
+                list_add_before(freelist, blk, after);
+                freelist->rover = &blk->link;
+            }
+            else {
+                list_add_to_back(fragments, blk);
+            }
+        }
+        curr = next;
+    }
+
+    while ((blk = list_remove_from_front(fragments)) != NULL)
+        list_add_to_freelist(freelist, blk, policy);
+    list_free(fragments);
+
+    free(order);
+    free(taken);
+    return allocated;
+}
+
+/**
+ * Function: allocate_memory_batch
+ * -------------------------------
+ * Allocates memory for a batch of requests.
+ *
+ * Parameters:
+ *  freelist: Pointer to the list of free memory blocks.
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  reqs: The requests; the start of each one's block is stored in it.
+ *  count: Number of requests.
+ *  policy: Memory management policy to use for allocation.
+ *  relaxed: Whether the requests may be served out of order.
+ *
+ * Returns:
+ *  The number of requests allocated.
+ *
+ * Description:
+ *  In strict mode every request gets the block allocate_memory would have
+ *  given it, had the requests been made one at a time in order. In relaxed
+ *  mode the batch is placed in a single pass over the free list, largest
+ *  requests first (see allocate_relaxed); the packed array, TLSF and buddy
+ *  backends have no such pass and serve relaxed batches in order too. Quick
+ *  lists serve their exact sizes first in either mode. The error of
+ *  allocate_memory is printed for every request left without a block.
+ */
+int allocate_memory_batch(list_t *freelist, list_t *alloclist, alloc_request_t *reqs, int count,
+                          int policy, bool relaxed) {
+    int allocated = 0;
+    block_t *blk;
+
+    if (relaxed && policy <= 4 && freelist->soa == NULL && freelist->tlsf == NULL) {
+        for (int i = 0; i < count; i++) {
+            blk = freelist->quick != NULL ? quick_pop(freelist->quick, reqs[i].size) : NULL;
+            reqs[i].start = -1;
+            if (blk != NULL) {
+                blk->pid = reqs[i].pid;
+                list_add_ascending_by_address(alloclist, blk);
+                reqs[i].start = blk->start;
+                allocated++;
+            }
+        }
+        if (allocated < count)
+            allocated += allocate_relaxed(freelist, alloclist, reqs, count, policy);
+    }
+    else {
+        for (int i = 0; i < count; i++) {
+            blk = try_allocate(freelist, alloclist, reqs[i].pid, reqs[i].size, policy);
+            reqs[i].start = blk != NULL ? blk->start : -1;
+            allocated += blk != NULL;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (reqs[i].start < 0)
+            fprintf(stderr, "Error: Not Enough Memory for PID %d\n", reqs[i].pid);
+    }
+    return allocated;
+}
+
+/**
+ * Function: merge_free_neighbors
+ * ------------------------------
+ * Absorbs the free blocks physically adjacent to blk into it.
+ *
+ * Parameters:
+ *  freelist: Pointer to an address indexed list of free memory blocks.
+ *  blk: Block being freed; it must not be on the free list yet.
+ *
+ * Description:
+ *  The left neighbour is the free block with the greatest start below blk and
+ *  the right neighbour the one starting just after blk; both are found through
+ *  the address index in O(log n), and their nodes are unlinked from the
+ *  free list and its indexes directly.
+ */
+static void merge_free_neighbors(list_t *freelist, block_t *blk) {
+    node_t *left = avl_floor(freelist->addr_index, blk->start - 1);
+    node_t *right = avl_lower_bound(freelist->addr_index, blk->end + 1);
+
+    if (left != NULL && left->blk->end + 1 == blk->start) {
+        blk->start = left->blk->start;
+        list_remove_node(freelist, left);
+        block_free(left->blk);
+    }
+    if (right != NULL && right->blk->start == blk->end + 1) {
+        blk->end = right->blk->end;
+        list_remove_node(freelist, right);
+        block_free(right->blk);
+    }
+}
+
+/* Puts a block that is no longer allocated on the free list: into a quick
+ * list, merged with its free neighbours (eager coalescing) or as it is. */
+static void release_block(list_t *freelist, block_t *blk, int policy) {
+    blk->pid = 0;  // Set PID to 0 to indicate that it is free
+    if (freelist->quick != NULL && quick_push(freelist->quick, blk))
+        return;  // cached until the next request of its size or coalesce
+    if (freelist->addr_index != NULL)
+        merge_free_neighbors(freelist, blk);
+    list_add_to_freelist(freelist, blk, policy);
+}
+
+/**
+ * Function: free_node
+ * -------------------
+ * Moves the allocated block at node back to the free memory of the policy.
+ */
+static void free_node(list_t *alloclist, list_t *freelist, node_t *node, int policy) {
+    if (policy == 5) {  // Buddy engine, merges with the buddy itself
+        buddy_free(alloclist, freelist, node);
+        return;
+    }
+
+    block_t *block_to_deallocate = node->blk;
+
+    // Remove the block from the allocated list; the block itself is kept
+    list_remove_node(alloclist, node);
+
+    if (freelist->tlsf != NULL) {  // the engine merges it with free neighbours
+        tlsf_release(freelist->tlsf, block_to_deallocate->tag);
+        freelist->length = freelist->tlsf->free_blocks;
+        block_free(block_to_deallocate);
+        return;
+    }
+
+    //Add the block back to the free list
+    release_block(freelist, block_to_deallocate, policy);
 }
 
 /**
@@ -153,38 +798,418 @@ void allocate_memory(list_t *freelist, list_t *alloclist, int pid, int blocksize
  *  Supports 'First Fit', 'Best Fit', and 'Worst Fit' deallocation strategies.
  *  Finds and deallocates a memory block assigned to a specific process ID.
  *  The deallocated block is then added back to the free list according to the specified memory management policy.
+ *  If the free list has an address index, the block is first merged with its free
+ *  neighbours (eager coalescing). With a PID index on the allocated list the
+ *  block is found in O(1). Only the lowest addressed block of the PID is freed;
+ *  see deallocate_all_memory and deallocate_block.
  */
 void deallocate_memory(list_t *alloclist, list_t *freelist, int pid, int policy) {
-    node_t *current = alloclist->head;
-    node_t *prev = NULL;
-
     // Find the block with the given PID
-    while (current != NULL) {
-        if (current->blk->pid == pid) {
-            block_t *block_to_deallocate = current->blk;
-
-            //Add the block back to the free list
-            list_add_to_freelist(freelist, block_to_deallocate, policy);
-            block_to_deallocate->pid = 0;  // Set PID to 0 to indicate that it is free
-
-            // Remove the block from the allocated list
-            if (prev) {
-                prev->next = current->next;
-            } else {
-                alloclist->head = current->next;
-            }
+    node_t *current = list_get_node_by_pid(alloclist, pid);
+
+    if (current == NULL) {
+        fprintf(stderr, "Memory block with PID %d not found for deallocaiton\n", pid);
+        return; // returning early if not found
+    }
+    free_node(alloclist, freelist, current, policy);
+}
+
+/**
+ * Function: deallocate_all_memory
+ * -------------------------------
+ * Deallocates every block held by a process.
+ *
+ * Parameters:
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  freelist: Pointer to the list of free memory blocks.
+ *  pid: Process ID whose blocks are released.
+ *  policy: Memory management policy to use for deallocation.
+ *
+ * Returns:
+ *  The number of blocks released.
+ *
+ * Description:
+ *  With a PID index on the allocated list the PID's blocks are taken lowest
+ *  first, each in O(1) from its slot, so releasing k blocks costs O(k)
+ *  lookups rather than k walks of the list.
+ */
+int deallocate_all_memory(list_t *alloclist, list_t *freelist, int pid, int policy) {
+    int released = 0;
+    node_t *current;
 
-            // Safely removing the current node from the list, since its block is in the freelist
-            free(current);
-            alloclist->length--;
-            current = NULL; //Setting pointer to NULL to avoind dangling pointers
-            return; // exit after deallocation
+    while ((current = list_get_node_by_pid(alloclist, pid)) != NULL) {
+        free_node(alloclist, freelist, current, policy);
+        released++;
+    }
+    if (released == 0)
+        fprintf(stderr, "Memory block with PID %d not found for deallocaiton\n", pid);
+    return released;
+}
+
+/**
+ * Function: deallocate_block
+ * --------------------------
+ * Deallocates the block of a process that starts at a given address.
+ *
+ * Parameters:
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  freelist: Pointer to the list of free memory blocks.
+ *  pid: Process ID holding the block.
+ *  start: Start address of the block.
+ *  policy: Memory management policy to use for deallocation.
+ *
+ * Returns:
+ *  true if the block was found and released.
+ */
+bool deallocate_block(list_t *alloclist, list_t *freelist, int pid, int start, int policy) {
+    node_t *current = list_get_node_by_pid_at(alloclist, pid, start);
+
+    if (current == NULL) {
+        fprintf(stderr, "Memory block with PID %d at %d not found for deallocation\n", pid, start);
+        return false;
+    }
+    free_node(alloclist, freelist, current, policy);
+    return true;
+}
+
+/**
+ * Function: query_address
+ * -----------------------
+ * Finds out who owns an address of the partition.
+ *
+ * Parameters:
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  partition_size: Size of the partition, which starts at address 0.
+ *  addr: Address to look up.
+ *  owner: Filled in with the allocated block holding addr, or with pid 0 and
+ *         the free range around addr.
+ *
+ * Returns:
+ *  false if addr lies outside the partition.
+ *
+ * Description:
+ *  Everything that is not allocated is free, so only the allocated list is
+ *  searched. With an address index on it the query is O(log n) whichever
+ *  free list backend is in use, and cached or uncoalesced free blocks are
+ *  reported as one free range. The unused tail of a buddy block counts as free.
+ */
+bool query_address(list_t *alloclist, int partition_size, int addr, addr_owner_t *owner) {
+    if (addr < 0 || addr >= partition_size)
+        return false;
+
+    node_t *node = list_get_node_by_address(alloclist, addr);
+    if (node != NULL && node->blk->start <= addr) {
+        owner->pid = node->blk->pid;
+        owner->start = node->blk->start;
+        owner->end = node->blk->end;
+        return true;
+    }
+
+    owner->pid = 0;
+    owner->end = node != NULL ? node->blk->start - 1 : partition_size - 1;
+    node = node != NULL ? node->prev : alloclist->tail;
+    owner->start = node != NULL ? node->blk->end + 1 : 0;
+    return true;
+}
+
+/**
+ * Function: query_range
+ * ---------------------
+ * Finds the lowest addressed allocated block overlapping [lo, hi].
+ *
+ * Parameters:
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  lo, hi: Address range to look up.
+ *  owner: Filled in with that block, if there is one.
+ *
+ * Returns:
+ *  true if some of the range is allocated, false if all of it is free.
+ */
+bool query_range(list_t *alloclist, int lo, int hi, addr_owner_t *owner) {
+    node_t *node = list_get_node_by_address(alloclist, lo);
+
+    if (node == NULL || node->blk->start > hi)
+        return false;
+    owner->pid = node->blk->pid;
+    owner->start = node->blk->start;
+    owner->end = node->blk->end;
+    return true;
+}
+
+/**
+ * Function: translate_address
+ * ---------------------------
+ * Translates a virtual address of a process to a physical address.
+ *
+ * Parameters:
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  pager: The paging engine, or NULL for contiguous allocation.
+ *  tlb: TLB to look the page up in first, or NULL.
+ *  page_size: Page size of the translation.
+ *  pid: Process ID making the access.
+ *  vaddr: Virtual address accessed.
+ *  hit: Set to whether the TLB held the translation.
+ *
+ * Returns:
+ *  The physical address, or -1 if vaddr is not mapped.
+ *
+ * Description:
+ *  With paging the page table of pid is walked, faulting the page back in if
+ *  it was evicted. Under contiguous allocation
+ *  a process sees its lowest addressed block from virtual address 0 on, so
+ *  the translation adds its start, and the TLB caches the physical address
+ *  of each page_size byte page of the block. The block need not end on a
+ *  page boundary, so an entry also records how much of its page the block
+ *  covers, and a hit past that is as invalid as it is on a miss.
+ */
+int translate_address(list_t *alloclist, paging_t *pager, tlb_t *tlb, int page_size,
+                      int pid, int vaddr, bool *hit) {
+    long vpn = vaddr / page_size;
+    int base, size = page_size;
+
+    *hit = false;
+    if (vaddr < 0)
+        return -1;
+    if (tlb != NULL && tlb_lookup(tlb, pid, vpn, &base, &size)) {
+        if (pager != NULL)
+            paging_touch(pager, pid, vpn);  // resident, as evictions drop their entries
+        *hit = true;
+        return vaddr % page_size < size ? base + vaddr % page_size : -1;
+    }
+
+    if (pager != NULL) {
+        int frame = paging_access(pager, pid, vaddr);
+        if (frame < 0)
+            return -1;
+        base = frame * page_size;
+    }
+    else {
+        node_t *node = list_get_node_by_pid(alloclist, pid);
+        if (node == NULL || vaddr > node->blk->end - node->blk->start)
+            return -1;
+        base = node->blk->start + vpn * page_size;
+        if (node->blk->end - base + 1 < size)
+            size = node->blk->end - base + 1;  // the block ends in this page
+    }
+
+    if (tlb != NULL)
+        tlb_insert(tlb, pid, vpn, base, size);
+    return base + vaddr % page_size;
+}
+
+/**
+ * Function: grow_in_place
+ * -----------------------
+ * Extends an allocated block by extra bytes into the free block that starts
+ * right after it.
+ *
+ * Returns:
+ *  false, changing nothing, if there is no such free block or it is too
+ *  small. Blocks cached in quick lists are not considered.
+ *
+ * Description:
+ *  The free block is found through the address index if the free list has
+ *  one, otherwise by a walk. What is left of it is put back the way
+ *  allocate_memory puts back the remainder of a split block.
+ */
+static bool grow_in_place(list_t *freelist, block_t *blk, int extra, int policy) {
+    int next_start = blk->end + 1;
+    node_t *next;
+
+    if (freelist->soa != NULL) {
+        soa_store_t *store = freelist->soa;
+        int i = soa_find_start(store, next_start);
+        if (i < 0 || store->size[i] < extra)
+            return false;
+
+        int fragment_end = store->start[i] + store->size[i] - 1;
+        blk->end += extra;
+        if (policy == 4) {  // Next Fit: the remainder stays where it is
+            store->start[i] += extra;
+            store->size[i] -= extra;
+            if (store->size[i] > 0)
+                return true;
+        }
+        soa_remove(store, i);
+        freelist->length--;
+        if (policy != 4 && blk->end < fragment_end) {
+            soa_push(store, blk->end + 1, fragment_end);
+            freelist->length++;
+        }
+        return true;
+    }
+
+    if (freelist->addr_index != NULL) {
+        next = avl_lower_bound(freelist->addr_index, next_start);
+    } else {
+        for (next = freelist->head; next != NULL && next->blk->start != next_start; next = next->next)
+            ;
+    }
+    if (next == NULL || next->blk->start != next_start || next->blk->end - next->blk->start + 1 < extra)
+        return false;
+
+    block_t *fragment = next->blk;
+    node_t *after = next->next;
+    bool rover_here = freelist->rover == next;
+    list_remove_node(freelist, next);  // off the list before its key changes
+
+    blk->end += extra;
+    fragment->start += extra;
+    if (fragment->start > fragment->end) {
+        block_free(fragment);
+    }
+    else if (policy == 4) {  // Next Fit: keep the remainder in place
+        list_add_before(freelist, fragment, after);
+        if (rover_here)
+            freelist->rover = &fragment->link;
+    }
+    else {
+        list_add_to_freelist(freelist, fragment, policy);
+    }
+    return true;
+}
+
+/**
+ * Function: resize_memory
+ * -----------------------
+ * Changes the size of the block held by a process, like realloc.
+ *
+ * Parameters:
+ *  freelist: Pointer to the list of free memory blocks.
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  pid: Process ID whose (lowest addressed) block is resized.
+ *  newsize: New size of the block in bytes.
+ *  policy: Memory management policy in use.
+ *
+ * Returns:
+ *  How the block was resized (see resize_result_t).
+ *
+ * Description:
+ *  A block shrinks in place, its tail going back to the free list as if it
+ *  had been freed. It grows in place if the free block right after it is
+ *  large enough. Otherwise a new block is allocated by the policy and the old
+ *  one freed, in that order so that a failed move leaves the block as it
+ *  was. The buddy and TLSF engines do not support resizing.
+ */
+resize_result_t resize_memory(list_t *freelist, list_t *alloclist, int pid, int newsize, int policy) {
+    if (policy >= 5) {
+        fprintf(stderr, "Error: resize is not supported by the buddy and TLSF engines\n");
+        return RESIZE_FAILED;
+    }
+
+    node_t *current = list_get_node_by_pid(alloclist, pid);
+    if (current == NULL) {
+        fprintf(stderr, "Memory block with PID %d not found for resize\n", pid);
+        return RESIZE_FAILED;
+    }
+    if (newsize < 1) {
+        fprintf(stderr, "Error: Invalid size %d for PID %d\n", newsize, pid);
+        return RESIZE_FAILED;
+    }
+
+    block_t *blk = current->blk;
+    int size = blk->end - blk->start + 1;
+
+    if (newsize < size) {
+        block_t *tail = block_alloc();
+        tail->start = blk->start + newsize;
+        tail->end = blk->end;
+        blk->end = tail->start - 1;
+        release_block(freelist, tail, policy);
+        return RESIZE_IN_PLACE;
+    }
+    if (newsize == size || grow_in_place(freelist, blk, newsize - size, policy))
+        return RESIZE_IN_PLACE;
+
+    if (try_allocate(freelist, alloclist, pid, newsize, policy) == NULL) {
+        fprintf(stderr, "Error: Not Enough Memory for PID %d\n", pid);
+        return RESIZE_FAILED;
+    }
+    list_remove_node(alloclist, current);
+    release_block(freelist, blk, policy);
+    return RESIZE_MOVED;
+}
+
+/* Orders blocks by start address for qsort. */
+static int compare_start(const void *a, const void *b) {
+    const block_t *x = *(block_t * const *)a;
+    const block_t *y = *(block_t * const *)b;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+/**
+ * Function: coalese_indexed
+ * -------------------------
+ * Coalesces an indexed free list in place in O(n log n).
+ *
+ * Description:
+ *  The blocks are taken out of the list, sorted by address and merged. The
+ *  survivors are added back through the size index if there is one, otherwise
+ *  in address order like the unindexed coalesce.
+ */
+static void coalese_indexed(list_t *list) {
+    int n = list->length, kept = 0;
+    block_t **blks;
+
+    if (n == 0)
+        return;
+
+    blks = malloc(n * sizeof(block_t *));
+    if (blks == NULL) {
+        fprintf(stderr, "Error: coalese_memory failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < n; i++)
+        blks[i] = list_remove_from_front(list);
+    qsort(blks, n, sizeof(block_t *), compare_start);
+
+    for (int i = 1; i < n; i++) {
+        if (blks[kept]->end + 1 == blks[i]->start) {
+            blks[kept]->end = blks[i]->end; // physically adjacent, merge
+            block_free(blks[i]);
+        }
+        else {
+            blks[++kept] = blks[i];
+        }
+    }
+
+    if (list->size_index != NULL && list->size_index->order == AVL_TIE_NEWEST_FIRST) {
+        // Highest address first, so that of equal survivors the lowest comes
+        // first, as in the address ordered list of the unindexed coalesce
+        for (int i = kept; i >= 0; i--)
+            list_add_by_index(list, blks[i]);
+    }
+    else {
+        for (int i = 0; i <= kept; i++) {
+            if (list->size_index != NULL)
+                list_add_by_index(list, blks[i]);
+            else
+                list_add_to_back(list, blks[i]);
+        }
+    }
+
+    free(blks);
+}
+
+/* Points a next fit rover back at the block that now holds the address it was
+ * on before coalescing rebuilt the list. Does nothing if addr is negative.
+ * The block is looked up in the address index if there is one. */
+static void restore_rover(list_t *list, int addr) {
+    if (addr < 0)
+        return;
+    if (list->addr_index != NULL) {
+        node_t *holder = avl_floor(list->addr_index, addr);
+        if (holder != NULL && addr <= holder->blk->end)
+            list->rover = holder;
+        return;
+    }
+    for (node_t *curr = list->head; curr != NULL; curr = curr->next) {
+        if (curr->blk->start <= addr && addr <= curr->blk->end) {
+            list->rover = curr;
+            return;
         }
-        prev = current;
-        current = current->next;
     }
-    fprintf(stderr, "Memory block with PID %d not found for deallocaiton\n", pid);
-    return; // returning early if not found
 }
 
 /**
@@ -196,27 +1221,249 @@ void deallocate_memory(list_t *alloclist, list_t *freelist, int pid, int policy)
  *  list: Pointer to the list of free memory blocks.
  *
  * Returns:
- *  A new list with coalesced memory blocks.
+ *  A new list with coalesced memory blocks. An indexed or packed array list is
+ *  coalesced in place and returned itself, so it keeps its indexes or store.
  *
  * Description:
  *  Iterates through the given list of memory blocks and merges adjacent free blocks to form larger continuous memory spaces.
  *  This helps optimize the memory utilization and allocation process.
  */
 list_t* coalese_memory(list_t * list){
-  list_t *temp_list = list_alloc();
+  list_t *temp_list;
   block_t *blk;
+  node_t *resume = list->rover != NULL ? list->rover : list->head;  // where next fit would search next
+  int rover_start = resume != NULL ? resume->blk->start : -1;
+
+  list_flush_quick(list);  // cached blocks take part in the merge
+
+  if (list->soa != NULL) {
+      soa_coalesce(list->soa);
+      list->length = list->soa->count;
+      return list;
+  }
+
+  if (list->tlsf != NULL)
+      return list;  // freed blocks were merged on the spot
+
+  if (list->size_index != NULL || list->addr_index != NULL) {
+      coalese_indexed(list);
+      restore_rover(list, rover_start);
+      return list;
+  }
+
+  temp_list = list_alloc();
   
   while((blk = list_remove_from_front(list)) != NULL) {  // sort the list in ascending order by address
         list_add_ascending_by_address(temp_list, blk);
   }
   
+  temp_list->quick = list->quick;  // the caches move with the blocks
+  list->quick = NULL;
+
   // try to combine physically adjacent blocks
   
   list_coalese_nodes(temp_list);
+  restore_rover(temp_list, rover_start);
         
   return temp_list;
 }
 
+/**
+ * Function: compact_memory
+ * ------------------------
+ * Relocates allocated blocks so that all free memory forms one block.
+ *
+ * Parameters:
+ *  freelist: Pointer to the list of free memory blocks.
+ *  alloclist: Pointer to the list of allocated blocks, ascending by address.
+ *  policy: Memory management policy the free list is kept in (1 to 4).
+ *
+ * Returns:
+ *  The number of bytes relocated.
+ *
+ * Description:
+ *  Blocks keep their relative order. The planner picks a cut point k: the
+ *  first k allocated blocks are packed towards the low end of memory, the
+ *  rest towards the high end, and the free region lies in between. A block
+ *  already at its packed address is not moved, so the cost of cut k is the
+ *  size of the blocks below it that are not yet packed low plus those above
+ *  it not yet packed high. Every cut is priced in one pass and the cheapest
+ *  one is applied, so a single hole near either end moves only the blocks on
+ *  the short side of it.
+ */
+long compact_memory(list_t *freelist, list_t *alloclist, int policy) {
+    int lo = -1, hi = -1, free_bytes = 0;
+    long cost, best_cost, moved = 0;
+    int allocated = 0, below = 0, k = 0, best_k = 0, hole;
+    node_t *curr;
+    block_t *blk;
+
+    list_flush_quick(freelist);
+
+    // Bounds of memory and free byte count, from whichever backend holds the free blocks
+    if (freelist->soa != NULL) {
+        for (int i = 0; i < freelist->soa->count; i++) {
+            int start = freelist->soa->start[i], end = start + freelist->soa->size[i] - 1;
+            if (lo < 0 || start < lo) lo = start;
+            if (end > hi) hi = end;
+            free_bytes += freelist->soa->size[i];
+        }
+    } else {
+        for (curr = freelist->head; curr != NULL; curr = curr->next) {
+            if (lo < 0 || curr->blk->start < lo) lo = curr->blk->start;
+            if (curr->blk->end > hi) hi = curr->blk->end;
+            free_bytes += curr->blk->end - curr->blk->start + 1;
+        }
+    }
+    if (free_bytes == 0)
+        return 0;  // nothing to gather
+    for (curr = alloclist->head; curr != NULL; curr = curr->next) {
+        if (curr->blk->start < lo) lo = curr->blk->start;
+        if (curr->blk->end > hi) hi = curr->blk->end;
+        allocated += curr->blk->end - curr->blk->start + 1;
+    }
+
+    // Cut 0 packs everything high; moving the cut past a block packs it low instead
+    cost = 0;
+    for (curr = alloclist->head; curr != NULL; curr = curr->next) {
+        int size = curr->blk->end - curr->blk->start + 1;
+        if (curr->blk->start != hi - (allocated - below) + 1)
+            cost += size;
+        below += size;
+    }
+    best_cost = cost;
+    below = 0;
+    for (curr = alloclist->head; curr != NULL; curr = curr->next) {
+        int size = curr->blk->end - curr->blk->start + 1;
+        if (curr->blk->start != hi - (allocated - below) + 1)
+            cost -= size;
+        if (curr->blk->start != lo + below)
+            cost += size;
+        below += size;
+        k++;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_k = k;
+        }
+    }
+
+    // Apply the cut. Blocks keep their order, but a block may move onto the old
+    // start of one not moved yet, so the address index is rebuilt afterwards.
+    hole = lo;
+    below = 0;
+    k = 0;
+    for (curr = alloclist->head; curr != NULL; curr = curr->next, k++) {
+        int size = curr->blk->end - curr->blk->start + 1;
+        int start = k < best_k ? lo + below : hi - (allocated - below) + 1;
+        if (curr->blk->start != start) {
+            curr->blk->start = start;
+            curr->blk->end = start + size - 1;
+            moved += size;
+        }
+        below += size;
+        if (k < best_k)
+            hole = lo + below;
+    }
+    if (moved > 0 && alloclist->addr_index != NULL) {
+        avl_free(alloclist->addr_index);
+        alloclist->addr_index = NULL;
+        list_index_by_address(alloclist);
+    }
+
+    // Replace the free blocks by the single region left between the two sides
+    if (freelist->soa != NULL) {
+        freelist->soa->count = 0;
+        freelist->soa->rover = 0;
+        freelist->length = 0;
+    } else {
+        while ((blk = list_remove_from_front(freelist)) != NULL)
+            block_free(blk);
+    }
+    blk = block_alloc();
+    blk->pid = 0;
+    blk->start = hole;
+    blk->end = blk->start + free_bytes - 1;
+    list_add_to_freelist(freelist, blk, policy);
+
+    return moved;
+}
+
+/* Returns true if lazy mode should coalesce before the next allocation. */
+static bool lazy_threshold_crossed(list_t *freelist, lazy_coalesce_t *lazy) {
+    if (lazy->max_length > 0 && freelist->length >= lazy->max_length)
+        return true;
+    if (lazy->max_frag > 0) {
+        int free_bytes, holes, largest;
+        free_list_summary(freelist, &free_bytes, &holes, &largest);
+        return free_bytes > 0 && 100L * (free_bytes - largest) >= (long)lazy->max_frag * free_bytes;
+    }
+    return false;
+}
+
+/**
+ * Function: allocate_memory_lazy
+ * ------------------------------
+ * allocate_memory with lazy coalescing.
+ *
+ * Parameters:
+ *  freelist: Pointer to the list of free memory blocks.
+ *  alloclist: Pointer to the list of allocated memory blocks.
+ *  pid: Process ID requesting memory allocation.
+ *  blocksize: Size of the memory block to allocate.
+ *  policy: Memory management policy to use for allocation.
+ *  lazy: Thresholds and counters of the mode. The caller sets lazy->dirty
+ *        whenever it frees a block and clears it when it coalesces.
+ *
+ * Returns:
+ *  The free list, which is a new list if it had to be coalesced (see
+ *  coalese_memory).
+ *
+ * Description:
+ *  The free list is coalesced before the allocation if one of the thresholds
+ *  is crossed, and after it if no block could hold the request, in which case
+ *  the allocation is retried once. Either is skipped unless a block has been
+ *  freed since the last coalesce, because allocations alone never leave two
+ *  free blocks next to each other, and the retry also when there are fewer
+ *  free bytes than requested.
+ */
+list_t* allocate_memory_lazy(list_t *freelist, list_t *alloclist, int pid, int blocksize, int policy,
+                             lazy_coalesce_t *lazy) {
+    if (lazy->dirty && lazy_threshold_crossed(freelist, lazy)) {
+        freelist = coalese_memory(freelist);
+        lazy->dirty = false;
+        lazy->coalesces++;
+    }
+
+    if (try_allocate(freelist, alloclist, pid, blocksize, policy) != NULL)
+        return freelist;
+
+    int free_bytes, holes, largest;
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    if (lazy->dirty && free_bytes >= blocksize) {  // else no merge can make room
+        freelist = coalese_memory(freelist);
+        lazy->dirty = false;
+        lazy->coalesces++;
+        if (try_allocate(freelist, alloclist, pid, blocksize, policy) != NULL) {
+            lazy->rescued++;
+            return freelist;
+        }
+    }
+
+    fprintf(stderr, "Error: Not Enough Memory for PID %d\n", pid);
+    return freelist;
+}
+
+/* Prints the blocks cached in quick lists after a free list's own blocks,
+ * numbered on from i. */
+static void print_cached(quick_lists_t *quick, int i) {
+    if (quick == NULL)
+        return;
+    for (int size = 1; size <= QUICK_MAX_SIZE; size++) {
+        for (node_t *node = quick->classes[size].top; node != NULL; node = node->next)
+            printf("Block %d:\t START: %d\t END: %d\n", i++, node->blk->start, node->blk->end);
+    }
+}
+
 /**
  * Function: print_list
  * --------------------
@@ -235,6 +1482,24 @@ void print_list(list_t * list, char * message){
     int i = 0;
   
     printf("%s:\n", message);
+
+    if (list->soa != NULL) { // packed array free list: free blocks in store order
+        for (i = 0; i < list->soa->count; i++)
+            printf("Block %d:\t START: %d\t END: %d\n", i, list->soa->start[i],
+                   list->soa->start[i] + list->soa->size[i] - 1);
+        print_cached(list->quick, i);
+        return;
+    }
+
+    if (list->tlsf != NULL) { // TLSF engine: free blocks in address order
+        tlsf_t *t = list->tlsf;
+        for (int h = t->first; h >= 0; h = t->hdr[h].phys_next) {
+            if (t->hdr[h].free)
+                printf("Block %d:\t START: %d\t END: %d\n", i++, t->hdr[h].start,
+                       t->hdr[h].start + t->hdr[h].size - 1);
+        }
+        return;
+    }
   
     while(current != NULL){
         blk = current->blk;
@@ -248,6 +1513,148 @@ void print_list(list_t * list, char * message){
         current = current->next;
         i += 1;
     }
+    print_cached(list->quick, i);
+}
+
+/**
+ * Function: free_list_summary
+ * ---------------------------
+ * Measures the fragmentation of a free list.
+ *
+ * Parameters:
+ *  list: Pointer to the free list.
+ *  free_bytes: Pointer to store the total size of the free blocks.
+ *  holes: Pointer to store the number of free blocks.
+ *  largest: Pointer to store the size of the largest free block (0 if none).
+ */
+void free_list_summary(list_t *list, int *free_bytes, int *holes, int *largest) {
+    *free_bytes = *holes = *largest = 0;
+
+    if (list->quick != NULL) {  // cached blocks are free memory too
+        for (int size = 1; size <= QUICK_MAX_SIZE; size++) {
+            *free_bytes += size * list->quick->classes[size].count;
+            *holes += list->quick->classes[size].count;
+            if (list->quick->classes[size].count > 0)
+                *largest = size;
+        }
+    }
+
+    if (list->soa != NULL) {
+        for (int i = 0; i < list->soa->count; i++) {
+            *free_bytes += list->soa->size[i];
+            if (list->soa->size[i] > *largest)
+                *largest = list->soa->size[i];
+        }
+        *holes += list->soa->count;
+        return;
+    }
+
+    if (list->tlsf != NULL) {
+        tlsf_t *t = list->tlsf;
+        for (int h = t->first; h >= 0; h = t->hdr[h].phys_next) {
+            if (t->hdr[h].free) {
+                *free_bytes += t->hdr[h].size;
+                if (t->hdr[h].size > *largest)
+                    *largest = t->hdr[h].size;
+                (*holes)++;
+            }
+        }
+        return;
+    }
+
+    for (node_t *current = list->head; current != NULL; current = current->next) {
+        int size = current->blk->end - current->blk->start + 1;
+        *free_bytes += size;
+        if (size > *largest)
+            *largest = size;
+        (*holes)++;
+    }
+}
+
+/**
+ * Function: print_summary
+ * -----------------------
+ * Prints the one line per operation report of -SUMMARY.
+ */
+void print_summary(list_t *freelist, long step) {
+    int free_bytes, holes, largest;
+
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    printf("STEP %ld:\t FREE: %d\t HOLES: %d\t LARGEST: %d\n", step, free_bytes, holes, largest);
+}
+
+#ifndef TESTING
+/**
+ * Function: evict_from_tlb
+ * ------------------------
+ * on_evict hook of an overcommitting pager: a TLB must not keep translating
+ * to the frame an evicted page gave up.
+ */
+static void evict_from_tlb(void *tlb, int pid, long vpn) {
+    tlb_invalidate_page(tlb, pid, vpn);
+}
+
+/**
+ * Function: print_replacement
+ * ---------------------------
+ * Prints the end of run counters of an overcommitting pager.
+ */
+static void print_replacement(paging_t *pager) {
+    static const char *names[] = {"LRU", "CLOCK", "ARC"};
+
+    printf("Page Replacement: %s\t ACCESSES: %ld\t FAULTS: %ld (%.2f%%)\t EVICTIONS: %ld\t SWAPPED: %ld (peak %ld)\n",
+           names[pager->replacer->policy], pager->accesses, pager->faults,
+           pager->accesses > 0 ? 100.0 * pager->faults / pager->accesses : 0.0, pager->evictions,
+           pager->swapped, pager->peak_swapped);
+}
+
+/**
+ * Function: print_state
+ * ---------------------
+ * Prints both lists, followed for the buddy engine by its internal
+ * fragmentation, or the state of the paging engine if there is one.
+ */
+static void print_state(list_t *freelist, list_t *alloclist, int policy, paging_t *pager) {
+    if (pager != NULL) {
+        paging_print(pager);
+        printf("\n\n");
+        return;
+    }
+
+    print_list(freelist, "Free Memory");
+    print_list(alloclist,"\nAllocated Memory");
+
+    if (policy == 5) {
+        buddy_stats_t stats;
+        buddy_stats(alloclist, &stats);
+        printf("\nInternal Fragmentation: %ld of %ld reserved bytes in %d blocks (%.2f%%)\n",
+               stats.reserved - stats.requested, stats.reserved, stats.blocks,
+               stats.reserved > 0 ? 100.0 * (stats.reserved - stats.requested) / stats.reserved : 0.0);
+    }
+    printf("\n\n");
+}
+
+/**
+ * Function: read_batch
+ * --------------------
+ * Collects the allocate op in inputdata and up to max - 1 allocate ops
+ * following it into batch.
+ *
+ * Returns:
+ *  The number of requests collected. *read_ahead is set if the op after
+ *  them was read too; it is left in inputdata.
+ */
+static int read_batch(trace_reader_t *trace, int inputdata[TRACE_OP_WORDS], alloc_request_t *batch, int max,
+                      bool *read_ahead) {
+    int n = 0;
+
+    do {
+        batch[n].pid = inputdata[0];
+        batch[n].size = inputdata[1];
+        n++;
+        *read_ahead = n < max && trace_next(trace, inputdata);
+    } while (*read_ahead && inputdata[0] > 0 && inputdata[0] != -99999);
+    return n;
 }
 
 /* DO NOT MODIFY */
@@ -268,60 +1675,236 @@ void print_list(list_t * list, char * message){
  *  Processes input data for memory allocation and deallocation requests and executes these requests based on the specified policy.
  */
 
-#ifndef TESTING
 int main(int argc, char *argv[]) 
 {
-   int PARTITION_SIZE, inputdata[200][2], N = 0, Memory_Mgt_Policy;
+   int PARTITION_SIZE, inputdata[TRACE_OP_WORDS], Memory_Mgt_Policy;
+   long step = 0;
+   long relocated = 0;                 // bytes moved by -C compaction
+   lazy_coalesce_t lazy = {0};         // -L state
+   alloc_request_t *batch = NULL;      // -BATCH requests
+   int batched;                        // requests in this step's batch, 0 if none
+   bool read_ahead = false;            // inputdata already holds the next op
+   bool dump;                          // print this step in full
+   trace_reader_t *trace;              // operations are streamed, one at a time
+   mmu_options_t opts;
+   addr_owner_t owner;                 // answer to a query op
+   paging_t *pager = NULL;             // -G engine, which replaces both lists
+   tlb_t *tlb = NULL;                  // -TLB model
+   bool hit;                           // an access op hit the TLB
   
    list_t *FREE_LIST = list_alloc();   // list that holds all free blocks (PID is always zero)
    list_t *ALLOC_LIST = list_alloc();  // list that holds all allocated blocks
-   int i;
   
-   if(argc != 3) {
-       printf("usage: ./mmu <input file> -{F | B | W }  \n(F=FIFO | B=BESTFIT | W-WORSTFIT)\n");
-       exit(1);
+   if(argc < 3) {
+       usage();
    }
   
-   get_input(argv, inputdata, &N, &PARTITION_SIZE, &Memory_Mgt_Policy);
+   get_input(argv, &trace, &PARTITION_SIZE, &Memory_Mgt_Policy);
+   get_options(argc, argv, &opts);
+   if (Memory_Mgt_Policy >= 5 && (opts.indexed || opts.eager_coalesce || opts.soa || opts.quick || opts.compact || opts.lazy))
+       usage();   // the buddy and TLSF engines bring their own indexes and merging
+   if (Memory_Mgt_Policy == 7 && opts.batch > 0)
+       usage();
+   if (Memory_Mgt_Policy != 7 && opts.replace >= 0)
+       usage();   // only pages can be evicted
   
    // Allocated the initial partition of size PARTITION_SIZE
    
-   block_t * partition = malloc(sizeof(block_t));   // create the partition meta data
+   block_t * partition = block_alloc();   // create the partition meta data
+   partition->pid = 0;
    partition->start = 0;
    partition->end = PARTITION_SIZE + partition->start - 1;
                                    
    list_add_to_front(FREE_LIST, partition);          // add partition to free list
 
+   if (opts.indexed)
+       list_index_by_size(FREE_LIST, Memory_Mgt_Policy);  // best/worst fit in O(log n)
+   if (opts.eager_coalesce)
+       list_index_by_address(FREE_LIST);                  // merge neighbours on free
+   if (opts.soa)
+       list_use_soa(FREE_LIST, opts.soa_isa);             // vectorized fit search
+
+   if (Memory_Mgt_Policy == 5)
+       buddy_init(FREE_LIST);                             // power of two blocks
+   if (Memory_Mgt_Policy == 6)
+       list_use_tlsf(FREE_LIST);                          // O(1) segregated fit
+   if (Memory_Mgt_Policy == 7)
+       pager = paging_alloc(PARTITION_SIZE, opts.page_size, opts.levels);
+   if (opts.tlb_entries > 0) {
+       int ways = opts.tlb_ways < opts.tlb_entries ? opts.tlb_ways : opts.tlb_entries;
+       if ((tlb = tlb_alloc(opts.tlb_entries, ways, opts.tlb_policy, opts.tlb_tags)) == NULL)
+           usage();   // the sets have to be a power of two
+   }
+   if (opts.replace >= 0) {
+       paging_use_replacement(pager, opts.replace);
+       if (tlb != NULL) {
+           pager->on_evict = evict_from_tlb;              // an evicted page must miss
+           pager->evict_arg = tlb;
+       }
+   }
+
+   if (opts.batch > 0 && (batch = malloc(opts.batch * sizeof(*batch))) == NULL) {
+       fprintf(stderr, "Error: out of memory for an allocation batch\n");
+       exit(EXIT_FAILURE);
+   }
+   lazy.max_length = opts.lazy_length;
+   lazy.max_frag = opts.lazy_frag;
+
+   if (opts.quick)
+       list_use_quick(FREE_LIST, Memory_Mgt_Policy);      // O(1) small exact size requests
+
+   list_index_by_pid(ALLOC_LIST);                         // O(1) deallocation by PID
+   list_index_by_address(ALLOC_LIST);                     // O(log n) ordered insert
+
    // Check for empty input data
-    if (N == 0) {
+    if (!trace_next(trace, inputdata)) {
         fprintf(stderr, "Error: No data in input file\n");
         exit(EXIT_FAILURE);
     }
                                    
-   for(i = 0; i < N; i++) // loop through all the input data and simulate a memory management policy
+   do // loop through all the input data and simulate a memory management policy
    {
-       printf("************************\n");
-       if(inputdata[i][0] != -99999 && inputdata[i][0] > 0) {
-             printf("ALLOCATE: %d FROM PID: %d\n", inputdata[i][1], inputdata[i][0]);
-             allocate_memory(FREE_LIST, ALLOC_LIST, inputdata[i][0], inputdata[i][1], Memory_Mgt_Policy);
+       batched = 0;
+       if (opts.batch > 0 && inputdata[0] != -99999 && inputdata[0] > 0)
+           batched = read_batch(trace, inputdata, batch, opts.batch, &read_ahead);
+       else
+           read_ahead = false;
+
+       step += batched > 1 ? batched : 1;
+       dump = opts.output == OUTPUT_FULL ||   // with a batch, any of its ops due
+              (opts.output == OUTPUT_EVERY && step % opts.output_every < (batched > 1 ? batched : 1));
+
+       if (dump)
+           printf("************************\n");
+       if (batched > 0) {
+             for (int i = 0; dump && i < batched; i++)
+                 printf("ALLOCATE: %d FROM PID: %d\n", batch[i].size, batch[i].pid);
+             allocate_memory_batch(FREE_LIST, ALLOC_LIST, batch, batched, Memory_Mgt_Policy, opts.relaxed);
+             for (int i = 0; tlb != NULL && i < batched; i++)
+                 tlb_invalidate_pid(tlb, batch[i].pid);  // a lower block moves the PID's address 0
+       }
+       else if(inputdata[0] != -99999 && inputdata[0] > 0) {
+             if (dump)
+                 printf("ALLOCATE: %d FROM PID: %d\n", inputdata[1], inputdata[0]);
+             if (pager != NULL) {
+                 if (paging_map(pager, inputdata[0], inputdata[1]) < 0)
+                     fprintf(stderr, "Error: Not Enough Memory for PID %d\n", inputdata[0]);
+             }
+             else if (opts.lazy)
+                 FREE_LIST = allocate_memory_lazy(FREE_LIST, ALLOC_LIST, inputdata[0], inputdata[1],
+                                                  Memory_Mgt_Policy, &lazy);
+             else
+                 allocate_memory(FREE_LIST, ALLOC_LIST, inputdata[0], inputdata[1], Memory_Mgt_Policy);
+             if (pager == NULL && tlb != NULL)
+                 tlb_invalidate_pid(tlb, inputdata[0]);  // a lower block moves the PID's address 0
+       }
+       else if (inputdata[0] == TRACE_OP_RESIZE) {
+             if (dump)
+                 printf("RESIZE: PID %d TO %d\n", inputdata[1], inputdata[2]);
+             if (pager != NULL)
+                 fprintf(stderr, "Error: resize is not supported by the paging engine\n");
+             else if (resize_memory(FREE_LIST, ALLOC_LIST, inputdata[1], inputdata[2], Memory_Mgt_Policy) != RESIZE_FAILED)
+                 lazy.dirty = true;  // a shrink or move frees memory
+             if (tlb != NULL)
+                 tlb_invalidate_pid(tlb, inputdata[1]);
+       }
+       else if (inputdata[0] == TRACE_OP_ACCESS) {
+             int paddr = translate_address(ALLOC_LIST, pager, tlb, opts.page_size, inputdata[1], inputdata[2], &hit);
+             if (dump)
+                 printf("ACCESS: PID %d ADDRESS %d\n", inputdata[1], inputdata[2]);
+             if (paddr < 0)
+                 fprintf(stderr, "Error: Invalid address %d for PID %d\n", inputdata[2], inputdata[1]);
+             else if (dump)
+                 printf("PHYSICAL: %d%s\n", paddr, tlb == NULL ? "" : hit ? "\t TLB HIT" : "\t TLB MISS");
        }
-       else if (inputdata[i][0] != -99999 && inputdata[i][0] < 0) {
-             printf("DEALLOCATE MEM: PID %d\n", abs(inputdata[i][0]));
-             deallocate_memory(ALLOC_LIST, FREE_LIST, abs(inputdata[i][0]), Memory_Mgt_Policy);
+       else if (inputdata[0] == TRACE_OP_QUERY) {
+             bool point = inputdata[1] == inputdata[2];
+             if (dump)
+                 printf("QUERY: %d TO %d\n", inputdata[1], inputdata[2]);
+             if (pager != NULL) {
+                 fprintf(stderr, "Error: address queries are not supported by the paging engine\n");
+             }
+             else if (point ? query_address(ALLOC_LIST, PARTITION_SIZE, inputdata[1], &owner)
+                            : query_range(ALLOC_LIST, inputdata[1], inputdata[2], &owner)) {
+                 if (dump && owner.pid > 0)
+                     printf("OWNER: PID %d\t START: %d\t END: %d\n", owner.pid, owner.start, owner.end);
+                 else if (dump)
+                     printf("OWNER: FREE\t START: %d\t END: %d\n", owner.start, owner.end);
+             }
+             else if (dump) {
+                 printf(point ? "OWNER: OUTSIDE THE PARTITION\n" : "OWNER: FREE\n");
+             }
+       }
+       else if (inputdata[0] == TRACE_OP_FREE_AT) {
+             if (dump)
+                 printf("DEALLOCATE MEM: PID %d AT %d\n", inputdata[1], inputdata[2]);
+             if (pager != NULL)
+                 fprintf(stderr, "Error: freeing by address is not supported by the paging engine\n");
+             else if (deallocate_block(ALLOC_LIST, FREE_LIST, inputdata[1], inputdata[2], Memory_Mgt_Policy))
+                 lazy.dirty = true;
+             if (tlb != NULL)
+                 tlb_invalidate_pid(tlb, inputdata[1]);
+       }
+       else if (inputdata[0] != -99999 && inputdata[0] < 0) {
+             if (dump)
+                 printf("DEALLOCATE MEM: PID %d\n", abs(inputdata[0]));
+             if (pager != NULL) {
+                 if (!(opts.pid_free ? paging_unmap_all(pager, abs(inputdata[0])) > 0
+                                     : paging_unmap(pager, abs(inputdata[0]))))
+                     fprintf(stderr, "Memory block with PID %d not found for deallocaiton\n", abs(inputdata[0]));
+             }
+             else if (opts.pid_free)
+                 deallocate_all_memory(ALLOC_LIST, FREE_LIST, abs(inputdata[0]), Memory_Mgt_Policy);
+             else
+                 deallocate_memory(ALLOC_LIST, FREE_LIST, abs(inputdata[0]), Memory_Mgt_Policy);
+             if (tlb != NULL)
+                 tlb_invalidate_pid(tlb, abs(inputdata[0]));
+             lazy.dirty = true;
        }
        else {
-             printf("COALESCE/COMPACT\n");
-             FREE_LIST = coalese_memory(FREE_LIST);
+             if (dump)
+                 printf("COALESCE/COMPACT\n");
+             if (opts.compact) {
+                 long moved = compact_memory(FREE_LIST, ALLOC_LIST, Memory_Mgt_Policy);
+                 if (dump)
+                     printf("RELOCATED: %ld BYTES\n", moved);
+                 relocated += moved;
+                 if (tlb != NULL && moved > 0)
+                     tlb_invalidate_all(tlb);
+             }
+             else if (Memory_Mgt_Policy != 5 && pager == NULL)  // buddies merge on free, frames never need to
+                 FREE_LIST = coalese_memory(FREE_LIST);
+             lazy.dirty = false;
        }   
      
-       printf("************************\n");
-       print_list(FREE_LIST, "Free Memory");
-       print_list(ALLOC_LIST,"\nAllocated Memory");
-       printf("\n\n");
-   }
+       if (dump) {
+           printf("************************\n");
+           print_state(FREE_LIST, ALLOC_LIST, Memory_Mgt_Policy, pager);
+       }
+       else if (opts.output == OUTPUT_SUMMARY && pager != NULL) {
+           printf("STEP %ld:\t FREE FRAMES: %d\t MAPPED PAGES: %ld\n", step, pager->frames.free, pager->mapped_pages);
+       }
+       else if (opts.output == OUTPUT_SUMMARY) {
+           print_summary(FREE_LIST, step);
+       }
+   } while (read_ahead || trace_next(trace, inputdata));
+
+   if (opts.output == OUTPUT_FINAL)
+       print_state(FREE_LIST, ALLOC_LIST, Memory_Mgt_Policy, pager);
+   if (opts.compact && opts.output != OUTPUT_QUIET)
+       printf("Total Relocated: %ld bytes\n", relocated);
+   if (opts.lazy && opts.output != OUTPUT_QUIET)
+       printf("Lazy Coalescing: %ld coalesces, %ld allocations rescued\n", lazy.coalesces, lazy.rescued);
+   if (tlb != NULL && opts.output != OUTPUT_QUIET)
+       tlb_print_stats(tlb);
+   if (pager != NULL && pager->replacer != NULL && opts.output != OUTPUT_QUIET)
+       print_replacement(pager);
+   free(batch);
+   paging_free(pager);
+   tlb_free(tlb);
   
-   list_free(FREE_LIST);
-   list_free(ALLOC_LIST);
+   trace_close(trace);
+   list_release_all();   // frees both lists, their nodes and blocks in one bulk release
   
    return 0;
 }
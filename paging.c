@@ -0,0 +1,493 @@
+// paging.c
+//
+// Implementation for the paging engine.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "./Headers/paging.h"
+
+#define PAGING_INITIAL_PROCS 64
+#define PAGING_INITIAL_REGIONS 4
+
+static mem_stats_t engine_bytes;
+
+/***** Helpers ********/
+
+static void *checked_calloc(size_t count, size_t size) {
+    void *p = calloc(count, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: paging engine out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/* Takes the first free frame at or after the hint word. Returns -1 if every
+ * frame is in use. */
+static int frame_take(frame_bitmap_t *fb) {
+    int words = (fb->frames + 63) / 64;
+
+    for (int n = 0; n < words; n++) {
+        int w = (fb->hint + n) % words;
+        uint64_t free_bits = ~fb->words[w];
+        if (free_bits != 0) {
+            int bit = __builtin_ctzll(free_bits);
+            fb->words[w] |= (uint64_t)1 << bit;
+            fb->free--;
+            fb->hint = w;
+            return w * 64 + bit;
+        }
+    }
+    return -1;
+}
+
+static void frame_put(frame_bitmap_t *fb, int frame) {
+    fb->words[frame / 64] &= ~((uint64_t)1 << (frame % 64));
+    fb->free++;
+}
+
+static page_table_t *new_table(paging_t *pg, int level) {
+    mem_stats_track(&engine_bytes, sizeof(page_table_t));
+    if (++pg->tables[level] > pg->peak_tables[level])
+        pg->peak_tables[level] = pg->tables[level];
+    return checked_calloc(1, sizeof(page_table_t));
+}
+
+static void free_table(paging_t *pg, page_table_t *table, int level) {
+    mem_stats_track(&engine_bytes, -(long)sizeof(page_table_t));
+    pg->tables[level]--;
+    free(table);
+}
+
+/* Returns the table index of vpn at a level. */
+static int table_index(const paging_t *pg, long vpn, int level) {
+    return (vpn >> ((pg->levels - 1 - level) * PAGING_LEVEL_BITS)) & (PAGING_TABLE_ENTRIES - 1);
+}
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u; // Knuth multiplicative hash
+}
+
+/* Returns the slot holding pid, or the empty slot where it would go. */
+static paging_process_t *find_proc(paging_t *pg, int pid) {
+    unsigned int mask = pg->proc_capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+
+    while (pg->procs[i].pid != 0 && pg->procs[i].pid != pid)
+        i = (i + 1) & mask;
+    return &pg->procs[i];
+}
+
+/* Doubles the process map once it is half full. */
+static void grow_procs(paging_t *pg) {
+    paging_process_t *old = pg->procs;
+    int old_capacity = pg->proc_capacity;
+
+    pg->proc_capacity *= 2;
+    pg->procs = checked_calloc(pg->proc_capacity, sizeof(paging_process_t));
+    mem_stats_track(&engine_bytes, (long)old_capacity * sizeof(paging_process_t));
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].pid != 0)
+            *find_proc(pg, old[i].pid) = old[i];
+    }
+    free(old);
+}
+
+/* Frees a process without regions and shifts later entries of the probe run
+ * back into its slot, as pid_map does. */
+static void delete_proc(paging_t *pg, paging_process_t *proc) {
+    unsigned int mask = pg->proc_capacity - 1;
+    unsigned int hole = proc - pg->procs;
+    unsigned int i = hole;
+
+    if (proc->root != NULL)
+        free_table(pg, proc->root, 0);
+    mem_stats_track(&engine_bytes, -(long)(proc->capacity * sizeof(paging_region_t)));
+    free(proc->regions);
+
+    while (1) {
+        i = (i + 1) & mask;
+        if (pg->procs[i].pid == 0)
+            break;
+
+        // Move the entry back only if its home slot is not in (hole, i]
+        unsigned int home = hash_pid(pg->procs[i].pid) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            pg->procs[hole] = pg->procs[i];
+            hole = i;
+        }
+    }
+    memset(&pg->procs[hole], 0, sizeof(paging_process_t));
+    pg->proc_used--;
+}
+
+/* Maps page vpn of proc to frame, adding the tables on its path. */
+static void map_page(paging_t *pg, paging_process_t *proc, long vpn, int frame) {
+    page_table_t *table = proc->root;
+
+    for (int level = 0; level < pg->levels - 1; level++) {
+        pte_t *pte = &table->entry[table_index(pg, vpn, level)];
+        if (pte->table == NULL) {
+            pte->table = new_table(pg, level + 1);
+            table->used++;
+        }
+        table = pte->table;
+    }
+    table->entry[table_index(pg, vpn, pg->levels - 1)].frame = frame + 1;
+    table->used++;
+}
+
+/* Unmaps page vpn of proc, giving its frame or its backing store page back.
+ * Tables below the root that become empty are freed. */
+static void unmap_page(paging_t *pg, paging_process_t *proc, long vpn) {
+    page_table_t *path[PAGING_MAX_LEVELS];
+
+    path[0] = proc->root;
+    for (int level = 1; level < pg->levels; level++)
+        path[level] = path[level - 1]->entry[table_index(pg, vpn, level - 1)].table;
+
+    pte_t *leaf = &path[pg->levels - 1]->entry[table_index(pg, vpn, pg->levels - 1)];
+    if (leaf->frame == PAGING_SWAPPED)
+        pg->swapped--;
+    else
+        frame_put(&pg->frames, leaf->frame - 1);
+    leaf->frame = 0;
+    if (pg->replacer != NULL)
+        replace_remove(pg->replacer, REPLACE_KEY(proc->pid, vpn));
+
+    for (int level = pg->levels - 1; level >= 0; level--) {
+        if (--path[level]->used > 0 || level == 0)
+            break;
+        free_table(pg, path[level], level);
+        path[level - 1]->entry[table_index(pg, vpn, level - 1)].table = NULL;
+    }
+}
+
+/* Unmaps region i of proc. */
+static void unmap_region(paging_t *pg, paging_process_t *proc, int i) {
+    paging_region_t *region = &proc->regions[i];
+
+    for (int p = 0; p < region->pages; p++)
+        unmap_page(pg, proc, region->vpn + p);
+    pg->mapped_pages -= region->pages;
+    pg->requested -= region->size;
+}
+
+/* Returns the last level entry of page vpn of proc, or NULL if no table on
+ * its path exists. */
+static pte_t *find_leaf(paging_t *pg, paging_process_t *proc, long vpn) {
+    page_table_t *table = proc->root;
+
+    for (int level = 0; level < pg->levels - 1 && table != NULL; level++)
+        table = table->entry[table_index(pg, vpn, level)].table;
+    return table != NULL ? &table->entry[table_index(pg, vpn, pg->levels - 1)] : NULL;
+}
+
+/* Moves a resident page to the backing store and frees its frame. */
+static void evict_page(paging_t *pg, uint64_t key) {
+    int pid = REPLACE_KEY_PID(key);
+    long vpn = REPLACE_KEY_VPN(key);
+    pte_t *leaf = find_leaf(pg, find_proc(pg, pid), vpn);
+
+    frame_put(&pg->frames, leaf->frame - 1);
+    leaf->frame = PAGING_SWAPPED;
+    pg->evictions++;
+    if (++pg->swapped > pg->peak_swapped)
+        pg->peak_swapped = pg->swapped;
+    if (pg->on_evict != NULL)
+        pg->on_evict(pg->evict_arg, pid, vpn);
+}
+
+/* Returns a frame for page vpn of pid, evicting another page if the
+ * replacement policy says so. */
+static int take_frame(paging_t *pg, int pid, long vpn) {
+    uint64_t victim;
+
+    if (pg->replacer != NULL && replace_admit(pg->replacer, REPLACE_KEY(pid, vpn), &victim))
+        evict_page(pg, victim);
+    return frame_take(&pg->frames);
+}
+
+static int compare_proc_pid(const void *a, const void *b) {
+    int x = (*(const paging_process_t *const *)a)->pid;
+    int y = (*(const paging_process_t *const *)b)->pid;
+    return (x > y) - (x < y);
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: paging_alloc
+ * ----------------------
+ * Allocates an engine with every frame of the partition free.
+ *
+ * Description:
+ *  The partition holds partition_size / page_size whole frames. The bits of
+ *  the last bitmap word past the last frame are set, so they are never taken.
+ */
+paging_t *paging_alloc(int partition_size, int page_size, int levels) {
+    paging_t *pg = checked_calloc(1, sizeof(paging_t));
+    int frames = partition_size / page_size;
+    int words = (frames + 63) / 64;
+
+    pg->page_size = page_size;
+    pg->levels = levels;
+    pg->frames.frames = frames;
+    pg->frames.free = frames;
+    pg->frames.words = checked_calloc(words > 0 ? words : 1, sizeof(uint64_t));
+    if (frames % 64 != 0)
+        pg->frames.words[words - 1] = ~(uint64_t)0 << (frames % 64);
+    pg->proc_capacity = PAGING_INITIAL_PROCS;
+    pg->procs = checked_calloc(pg->proc_capacity, sizeof(paging_process_t));
+    mem_stats_track(&engine_bytes, sizeof(paging_t) + words * sizeof(uint64_t) +
+                                   pg->proc_capacity * sizeof(paging_process_t));
+    return pg;
+}
+
+void paging_free(paging_t *pg) {
+    if (pg == NULL)
+        return;
+
+    for (int i = 0; i < pg->proc_capacity; i++) {
+        while (pg->procs[i].pid != 0) {  // deleting shifts the next process in
+            paging_process_t *proc = &pg->procs[i];
+            while (proc->count > 0)
+                unmap_region(pg, proc, --proc->count);
+            delete_proc(pg, proc);
+        }
+    }
+    mem_stats_track(&engine_bytes, -(long)(sizeof(paging_t) +
+                                           (pg->frames.frames + 63) / 64 * sizeof(uint64_t) +
+                                           pg->proc_capacity * sizeof(paging_process_t)));
+    replace_free(pg->replacer);
+    free(pg->frames.words);
+    free(pg->procs);
+    free(pg);
+}
+
+/**
+ * Function: paging_use_replacement
+ * --------------------------------
+ * Lets the engine map more pages than it has frames.
+ *
+ * Description:
+ *  Pages mapped from then on are tracked by a replacer for policy, which
+ *  picks the page to evict whenever a page needs a frame and none is free.
+ *  Call it before anything is mapped.
+ */
+void paging_use_replacement(paging_t *pg, replace_policy_t policy) {
+    if (pg->replacer == NULL && pg->frames.frames > 0)
+        pg->replacer = replace_alloc(policy, pg->frames.frames);
+}
+
+void paging_mem_stats(mem_stats_t *stats) {
+    stats->in_use += engine_bytes.in_use;
+    stats->peak += engine_bytes.peak;
+    replace_mem_stats(stats);
+}
+
+/**
+ * Function: paging_map
+ * --------------------
+ * Maps a new region of size bytes for pid.
+ *
+ * Description:
+ *  The region starts at the PID's next unused virtual page, so a PID's
+ *  regions never overlap. Every page gets the next free frame of the bitmap,
+ *  wherever it is. Nothing is mapped unless all pages can be, which with a
+ *  replacement policy only needs a frame to exist: mapping a page counts as
+ *  its first access, so other pages are evicted for it as needed.
+ */
+long paging_map(paging_t *pg, int pid, int size) {
+    long pages = size > 0 ? (size + (long)pg->page_size - 1) / pg->page_size : 1;
+    long vpn_limit = 1L << (pg->levels * PAGING_LEVEL_BITS);
+
+    if (pid <= 0 || pages > (pg->replacer != NULL ? pg->frames.frames : pg->frames.free))
+        return -1;
+
+    if (2 * (pg->proc_used + 1) > pg->proc_capacity)
+        grow_procs(pg);
+    paging_process_t *proc = find_proc(pg, pid);
+    if ((proc->pid != 0 ? proc->next_vpn : 0) + pages > vpn_limit)
+        return -1;
+    if (proc->pid == 0) {
+        proc->pid = pid;
+        proc->root = new_table(pg, 0);
+        proc->capacity = PAGING_INITIAL_REGIONS;
+        proc->regions = checked_calloc(proc->capacity, sizeof(paging_region_t));
+        mem_stats_track(&engine_bytes, proc->capacity * sizeof(paging_region_t));
+        pg->proc_used++;
+    }
+
+    if (proc->count == proc->capacity) {
+        paging_region_t *grown = realloc(proc->regions, 2 * proc->capacity * sizeof(paging_region_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: paging engine out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        mem_stats_track(&engine_bytes, proc->capacity * sizeof(paging_region_t));
+        proc->regions = grown;
+        proc->capacity *= 2;
+    }
+
+    paging_region_t *region = &proc->regions[proc->count++];
+    region->vpn = proc->next_vpn;
+    region->pages = pages;
+    region->size = size;
+    for (long p = 0; p < pages; p++)
+        map_page(pg, proc, region->vpn + p, take_frame(pg, pid, region->vpn + p));
+
+    proc->next_vpn += pages;
+    pg->mapped_pages += pages;
+    pg->requested += size;
+    return region->vpn * pg->page_size;
+}
+
+/**
+ * Function: paging_unmap
+ * ----------------------
+ * Unmaps the lowest region of pid and frees its frames.
+ *
+ * Description:
+ *  A PID left without regions is forgotten, so its next allocation starts
+ *  again at virtual address 0.
+ */
+bool paging_unmap(paging_t *pg, int pid) {
+    paging_process_t *proc = find_proc(pg, pid);
+
+    if (pid <= 0 || proc->pid == 0)
+        return false;
+
+    unmap_region(pg, proc, 0);
+    memmove(proc->regions, proc->regions + 1, --proc->count * sizeof(paging_region_t));
+    if (proc->count == 0)
+        delete_proc(pg, proc);
+    return true;
+}
+
+int paging_unmap_all(paging_t *pg, int pid) {
+    paging_process_t *proc = find_proc(pg, pid);
+    int count = proc->count;
+
+    if (pid <= 0 || proc->pid == 0)
+        return 0;
+
+    for (int i = 0; i < count; i++)
+        unmap_region(pg, proc, i);
+    proc->count = 0;
+    delete_proc(pg, proc);
+    return count;
+}
+
+/* Returns the last level entry of the page holding vaddr of pid, or NULL if
+ * the address cannot be mapped. */
+static pte_t *find_address(paging_t *pg, int pid, long vaddr) {
+    paging_process_t *proc = find_proc(pg, pid);
+
+    if (pid <= 0 || proc->pid == 0 || vaddr < 0)
+        return NULL;
+
+    long vpn = vaddr / pg->page_size;
+    if (vpn >= 1L << (pg->levels * PAGING_LEVEL_BITS))
+        return NULL;
+    return find_leaf(pg, proc, vpn);
+}
+
+/**
+ * Function: paging_translate
+ * --------------------------
+ * Walks pid's page table for the frame of a virtual address.
+ */
+int paging_translate(paging_t *pg, int pid, long vaddr) {
+    pte_t *leaf = find_address(pg, pid, vaddr);
+
+    return leaf != NULL && leaf->frame > 0 ? leaf->frame - 1 : -1;
+}
+
+/**
+ * Function: paging_access
+ * -----------------------
+ * Walks pid's page table for the frame of an address that is accessed.
+ *
+ * Description:
+ *  An access to an evicted page is a fault: the page is given a frame again,
+ *  possibly evicting another one. An access to a resident page is reported
+ *  to the replacement policy.
+ */
+int paging_access(paging_t *pg, int pid, long vaddr) {
+    pte_t *leaf = find_address(pg, pid, vaddr);
+    long vpn = vaddr / pg->page_size;
+
+    if (leaf == NULL || leaf->frame == 0)
+        return -1;
+
+    pg->accesses++;
+    if (leaf->frame == PAGING_SWAPPED) {
+        pg->faults++;
+        pg->swapped--;
+        leaf->frame = take_frame(pg, pid, vpn) + 1;  // the victim is another page
+    }
+    else if (pg->replacer != NULL) {
+        replace_touch(pg->replacer, REPLACE_KEY(pid, vpn));
+    }
+    return leaf->frame - 1;
+}
+
+void paging_touch(paging_t *pg, int pid, long vpn) {
+    pg->accesses++;
+    if (pg->replacer != NULL)
+        replace_touch(pg->replacer, REPLACE_KEY(pid, vpn));
+}
+
+/**
+ * Function: paging_print
+ * ----------------------
+ * Prints the state of the engine.
+ *
+ * Description:
+ *  Regions are listed by PID and, within a PID, by virtual address. The page
+ *  tables are reported per level with their current and peak memory, and the
+ *  bytes lost to rounding allocations up to whole pages as internal
+ *  fragmentation.
+ */
+void paging_print(paging_t *pg) {
+    paging_process_t **procs = malloc((pg->proc_used > 0 ? pg->proc_used : 1) * sizeof(*procs));
+    int n = 0, blkcnt = 0;
+    long mapped = pg->mapped_pages * pg->page_size;
+
+    if (procs == NULL) {
+        fprintf(stderr, "Error: paging engine out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < pg->proc_capacity; i++) {
+        if (pg->procs[i].pid != 0)
+            procs[n++] = &pg->procs[i];
+    }
+    qsort(procs, n, sizeof(*procs), compare_proc_pid);
+
+    printf("Free Frames: %d of %d (page size %d)\n", pg->frames.free, pg->frames.frames, pg->page_size);
+    printf("\nMapped Memory:\n");
+    for (int i = 0; i < n; i++) {
+        for (int r = 0; r < procs[i]->count; r++) {
+            paging_region_t *region = &procs[i]->regions[r];
+            printf("Region %d:\t VADDR: %ld\t SIZE: %d\t PAGES: %d\t PID: %d\n",
+                   blkcnt++, region->vpn * pg->page_size, region->size, region->pages, procs[i]->pid);
+        }
+    }
+    free(procs);
+
+    printf("\nPage Tables (%d levels):\n", pg->levels);
+    for (int level = 0; level < pg->levels; level++) {
+        printf("Level %d:\t TABLES: %ld\t BYTES: %ld\t PEAK BYTES: %ld\n", level, pg->tables[level],
+               pg->tables[level] * (long)sizeof(page_table_t),
+               pg->peak_tables[level] * (long)sizeof(page_table_t));
+    }
+    printf("\nInternal Fragmentation: %ld of %ld mapped bytes (%.2f%%)\n", mapped - pg->requested, mapped,
+           mapped > 0 ? 100.0 * (mapped - pg->requested) / mapped : 0.0);
+    if (pg->replacer != NULL)
+        printf("Backing Store: %ld pages (peak %ld), %ld faults, %ld evictions\n", pg->swapped,
+               pg->peak_swapped, pg->faults, pg->evictions);
+}
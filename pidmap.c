@@ -0,0 +1,292 @@
+// pidmap.c
+//
+// Implementation for the PID index of the allocated list.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "./Headers/pidmap.h"
+
+#define PID_MAP_INITIAL_CAPACITY 64
+
+static pid_map_t *live_maps = NULL;
+static mem_stats_t map_bytes;
+
+/***** Helpers ********/
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u; // Knuth multiplicative hash
+}
+
+static pid_slot_t *alloc_slots(int capacity) {
+    pid_slot_t *slots = calloc(capacity, sizeof(pid_slot_t));
+    if (slots == NULL) {
+        fprintf(stderr, "Error: pid_map_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return slots;
+}
+
+/* Returns the slot holding pid, or the empty slot where it would go. */
+static pid_slot_t *find_slot(pid_map_t *map, int pid) {
+    unsigned int mask = map->capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+
+    while (map->slots[i].pid != 0 && map->slots[i].pid != pid)
+        i = (i + 1) & mask;
+    return &map->slots[i];
+}
+
+/* Doubles the table once it is half full. */
+static void grow(pid_map_t *map) {
+    pid_slot_t *old = map->slots;
+    int old_capacity = map->capacity;
+
+    map->capacity *= 2;
+    map->slots = alloc_slots(map->capacity);
+    mem_stats_track(&map_bytes, (long)old_capacity * sizeof(pid_slot_t));
+
+    for (int i = 0; i < old_capacity; i++) {
+        if (old[i].pid != 0)
+            *find_slot(map, old[i].pid) = old[i];
+    }
+    free(old);
+}
+
+/* Returns the index in slot->rest of the first block starting at or above
+ * start, or the end of rest if there is none. */
+static int rest_search(const pid_slot_t *slot, int start) {
+    int lo = slot->first, hi = slot->first + slot->count - 1;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (slot->rest[mid]->blk->start < start)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Makes room at the end of slot->rest for one more block. A full array is
+ * moved back to its start, and doubled if that would leave it over half
+ * full, so appending stays amortized O(1) while the front is dropped. */
+static void rest_reserve(pid_slot_t *slot) {
+    int used = slot->count - 1;
+
+    if (slot->first + used < slot->capacity)
+        return;
+
+    if (2 * used >= slot->capacity) {
+        int capacity = slot->capacity == 0 ? 4 : 2 * slot->capacity;
+        node_t **rest = realloc(slot->rest, capacity * sizeof(node_t *));
+        if (rest == NULL) {
+            fprintf(stderr, "Error: pid_map_add failed\n");
+            exit(EXIT_FAILURE);
+        }
+        mem_stats_track(&map_bytes, (long)(capacity - slot->capacity) * sizeof(node_t *));
+        slot->rest = rest;
+        slot->capacity = capacity;
+    }
+    memmove(slot->rest, &slot->rest[slot->first], used * sizeof(node_t *));
+    slot->first = 0;
+}
+
+/* Frees slot->rest, which has to be empty. */
+static void rest_release(pid_slot_t *slot) {
+    mem_stats_track(&map_bytes, -(long)slot->capacity * sizeof(node_t *));
+    free(slot->rest);
+    slot->rest = NULL;
+    slot->capacity = 0;
+    slot->first = 0;
+}
+
+/* Empties slot and shifts later entries of the probe run back into the gap,
+ * so lookups never need tombstones. */
+static void delete_slot(pid_map_t *map, pid_slot_t *slot) {
+    unsigned int mask = map->capacity - 1;
+    unsigned int hole = slot - map->slots;
+    unsigned int i = hole;
+
+    while (1) {
+        i = (i + 1) & mask;
+        if (map->slots[i].pid == 0)
+            break;
+
+        // Move the entry back only if its home slot is not in (hole, i]
+        unsigned int home = hash_pid(map->slots[i].pid) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            map->slots[hole] = map->slots[i];
+            hole = i;
+        }
+    }
+    map->slots[hole].pid = 0;
+    map->slots[hole].count = 0;
+    map->slots[hole].capacity = 0;
+    map->slots[hole].first = 0;
+    map->slots[hole].node = NULL;
+    map->slots[hole].rest = NULL;
+    map->used--;
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: pid_map_alloc
+ * -----------------------
+ * Allocates an empty PID map. Exits with a failure status if malloc fails.
+ */
+pid_map_t *pid_map_alloc() {
+    pid_map_t *map = malloc(sizeof(pid_map_t));
+    if (map == NULL) {
+        fprintf(stderr, "Error: pid_map_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    map->capacity = PID_MAP_INITIAL_CAPACITY;
+    map->slots = alloc_slots(map->capacity);
+    map->used = 0;
+    mem_stats_track(&map_bytes, sizeof(pid_map_t) + map->capacity * sizeof(pid_slot_t));
+
+    map->prev = NULL;
+    map->next = live_maps;
+    if (live_maps != NULL)
+        live_maps->prev = map;
+    live_maps = map;
+    return map;
+}
+
+void pid_map_free(pid_map_t *map) {
+    if (map != NULL) {
+        if (map->prev != NULL)
+            map->prev->next = map->next;
+        else
+            live_maps = map->next;
+        if (map->next != NULL)
+            map->next->prev = map->prev;
+
+        for (int i = 0; i < map->capacity; i++) {
+            if (map->slots[i].rest != NULL)
+                rest_release(&map->slots[i]);
+        }
+        mem_stats_track(&map_bytes, -(long)(sizeof(pid_map_t) + map->capacity * sizeof(pid_slot_t)));
+        free(map->slots);
+        free(map);
+    }
+}
+
+void pid_map_release_all() {
+    while (live_maps != NULL)
+        pid_map_free(live_maps);
+}
+
+void pid_map_mem_stats(mem_stats_t *stats) {
+    stats->in_use += map_bytes.in_use;
+    stats->peak += map_bytes.peak;
+}
+
+node_t *pid_map_get(pid_map_t *map, int pid) {
+    if (pid <= 0)
+        return NULL;
+    return find_slot(map, pid)->node;
+}
+
+node_t *pid_map_get_at(pid_map_t *map, int pid, int start) {
+    if (pid <= 0)
+        return NULL;
+
+    pid_slot_t *slot = find_slot(map, pid);
+    if (slot->pid == 0 || slot->node->blk->start > start)
+        return NULL;
+    if (slot->node->blk->start == start)
+        return slot->node;
+
+    int i = rest_search(slot, start);
+    return i < slot->first + slot->count - 1 && slot->rest[i]->blk->start == start ? slot->rest[i] : NULL;
+}
+
+/**
+ * Function: pid_map_add
+ * ---------------------
+ * Records that node's block belongs to its PID.
+ *
+ * Description:
+ *  The map keeps the lowest addressed block of each PID, which is the one a
+ *  linear walk of the address ordered list would reach first. A new lowest
+ *  block pushes the old one onto the front of rest; any other block is moved
+ *  into rest at its address, which for a block above the others is the end.
+ */
+void pid_map_add(pid_map_t *map, node_t *node) {
+    int pid = node->blk->pid;
+    int start = node->blk->start;
+    if (pid <= 0)
+        return;
+
+    if (2 * (map->used + 1) > map->capacity)
+        grow(map);
+
+    pid_slot_t *slot = find_slot(map, pid);
+    if (slot->pid == 0) {
+        slot->pid = pid;
+        slot->count = 1;
+        slot->node = node;
+        map->used++;
+        return;
+    }
+
+    if (start < slot->node->blk->start && slot->first > 0) {
+        slot->rest[--slot->first] = slot->node;
+        slot->node = node;
+        slot->count++;
+        return;
+    }
+
+    rest_reserve(slot);
+    int end = slot->first + slot->count - 1;
+    int i = slot->first;   // where the old lowest block goes
+    if (start < slot->node->blk->start) {
+        node_t *lowest = slot->node;
+        slot->node = node;
+        node = lowest;
+    }
+    else {
+        i = rest_search(slot, start);
+    }
+    memmove(&slot->rest[i + 1], &slot->rest[i], (end - i) * sizeof(node_t *));
+    slot->rest[i] = node;
+    slot->count++;
+}
+
+/**
+ * Function: pid_map_remove
+ * ------------------------
+ * Forgets node's block. If it was the PID's first block, the next one takes
+ * its place from the front of rest.
+ */
+void pid_map_remove(pid_map_t *map, node_t *node) {
+    int pid = node->blk->pid;
+    if (pid <= 0)
+        return;
+
+    pid_slot_t *slot = find_slot(map, pid);
+    if (slot->pid == 0)
+        return;
+
+    if (slot->node == node) {
+        if (slot->count > 1)
+            slot->node = slot->rest[slot->first++];
+    }
+    else {
+        int end = slot->first + slot->count - 1;
+        int i = rest_search(slot, node->blk->start);
+        if (i == end || slot->rest[i] != node)
+            return;
+        memmove(&slot->rest[i], &slot->rest[i + 1], (end - 1 - i) * sizeof(node_t *));
+    }
+
+    if (--slot->count == 1 && slot->rest != NULL)
+        rest_release(slot);
+    else if (slot->count == 0)
+        delete_slot(map, slot);
+}
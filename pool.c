@@ -0,0 +1,113 @@
+// pool.c
+//
+// Implementation for fixed size object pools.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/pool.h"
+
+#define POOL_SLAB_BYTES (64 * 1024)
+
+/* Lays out the pool on first use: the object size is padded so every object
+ * can hold the free list link and stays pointer aligned. */
+static void pool_setup(pool_t *pool) {
+    size_t align = sizeof(void *);
+
+    if (pool->obj_size < sizeof(void *))
+        pool->obj_size = sizeof(void *);
+    pool->obj_size = (pool->obj_size + align - 1) / align * align;
+    pool->per_slab = (POOL_SLAB_BYTES - sizeof(pool_slab_t)) / pool->obj_size;
+    if (pool->per_slab == 0)
+        pool->per_slab = 1;
+}
+
+static void pool_grow(pool_t *pool) {
+    size_t bytes = sizeof(pool_slab_t) + pool->per_slab * pool->obj_size;
+    pool_slab_t *slab = malloc(bytes);
+    if (slab == NULL) {
+        fprintf(stderr, "Error: pool_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->bump = (char *)(slab + 1);
+    pool->bump_end = pool->bump + pool->per_slab * pool->obj_size;
+    pool->reserved += bytes;
+}
+
+/**
+ * Function: pool_alloc
+ * --------------------
+ * Returns an object from the pool: a recycled one if available, otherwise the
+ * next unused object of the newest slab. Exits with a failure status if a new
+ * slab cannot be allocated.
+ */
+void *pool_alloc(pool_t *pool) {
+    void *obj;
+
+    if (pool->free_list != NULL) {
+        obj = pool->free_list;
+        pool->free_list = *(void **)obj;
+    }
+    else {
+        if (pool->per_slab == 0)
+            pool_setup(pool);
+        if (pool->bump == pool->bump_end)
+            pool_grow(pool);
+        obj = pool->bump;
+        pool->bump += pool->obj_size;
+    }
+
+    if (++pool->in_use > pool->peak)
+        pool->peak = pool->in_use;
+    return obj;
+}
+
+/**
+ * Function: pool_free
+ * -------------------
+ * Returns an object to the pool for reuse. NULL is ignored.
+ */
+void pool_free(pool_t *pool, void *obj) {
+    if (obj == NULL)
+        return;
+
+    *(void **)obj = pool->free_list;
+    pool->free_list = obj;
+    pool->in_use--;
+}
+
+/**
+ * Function: pool_release
+ * ----------------------
+ * Frees all slabs of the pool. The pool can be used again afterwards; its peak
+ * is kept for reporting.
+ */
+void pool_release(pool_t *pool) {
+    pool_slab_t *slab = pool->slabs;
+
+    while (slab != NULL) {
+        pool_slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->bump = pool->bump_end = NULL;
+    pool->in_use = 0;
+    pool->reserved = 0;
+}
+
+void pool_mem_stats(const pool_t *pool, mem_stats_t *stats) {
+    stats->in_use += pool->in_use * pool->obj_size;
+    stats->peak += pool->peak * pool->obj_size;
+}
+
+void mem_stats_track(mem_stats_t *stats, long delta) {
+    stats->in_use += delta;
+    if (stats->in_use > stats->peak)
+        stats->peak = stats->in_use;
+}
@@ -0,0 +1,120 @@
+// quick.c
+//
+// Implementation for the size class quick lists.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/quick.h"
+
+static quick_lists_t *live_caches = NULL;
+static mem_stats_t cache_bytes;
+
+/***** Function Definitions ********/
+
+/**
+ * Function: quick_alloc
+ * ---------------------
+ * Allocates empty caches for a free list managed with policy. Exits with a
+ * failure status if malloc fails.
+ */
+quick_lists_t *quick_alloc(int policy) {
+    quick_lists_t *quick = calloc(1, sizeof(quick_lists_t));
+    if (quick == NULL) {
+        fprintf(stderr, "Error: quick_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+    quick->policy = policy;
+    mem_stats_track(&cache_bytes, sizeof(quick_lists_t));
+
+    quick->next = live_caches;
+    if (live_caches != NULL)
+        live_caches->prev = quick;
+    live_caches = quick;
+    return quick;
+}
+
+void quick_free(quick_lists_t *quick) {
+    if (quick != NULL) {
+        node_t *node = quick_take_all(quick);
+        while (node != NULL) {
+            node_t *next = node->next;
+            node_free(node);
+            node = next;
+        }
+
+        if (quick->prev != NULL)
+            quick->prev->next = quick->next;
+        else
+            live_caches = quick->next;
+        if (quick->next != NULL)
+            quick->next->prev = quick->prev;
+
+        mem_stats_track(&cache_bytes, -(long)sizeof(quick_lists_t));
+        free(quick);
+    }
+}
+
+void quick_release_all() {
+    while (live_caches != NULL) {
+        quick_lists_t *next = live_caches->next;
+        mem_stats_track(&cache_bytes, -(long)sizeof(quick_lists_t));
+        free(live_caches);
+        live_caches = next;
+    }
+}
+
+void quick_mem_stats(mem_stats_t *stats) {
+    stats->in_use += cache_bytes.in_use;
+    stats->peak += cache_bytes.peak;
+}
+
+bool quick_push(quick_lists_t *quick, block_t *blk) {
+    int size = blk->end - blk->start + 1;
+
+    if (size > QUICK_MAX_SIZE || quick->classes[size].count == QUICK_CLASS_LIMIT)
+        return false;
+
+    node_t *node = node_alloc(blk);
+    node->next = quick->classes[size].top;
+    quick->classes[size].top = node;
+    quick->classes[size].count++;
+    quick->cached++;
+    return true;
+}
+
+block_t *quick_pop(quick_lists_t *quick, int size) {
+    if (size < 1 || size > QUICK_MAX_SIZE)
+        return NULL;  // never cached, not a miss
+    if (quick->classes[size].top == NULL) {
+        quick->misses++;
+        return NULL;
+    }
+
+    node_t *node = quick->classes[size].top;
+    quick->classes[size].top = node->next;
+    quick->classes[size].count--;
+    quick->cached--;
+    quick->hits++;
+    node->next = NULL;
+    return node->blk;
+}
+
+node_t *quick_take_all(quick_lists_t *quick) {
+    node_t *chain = NULL;
+
+    for (int size = 1; quick->cached > 0 && size <= QUICK_MAX_SIZE; size++) {
+        node_t *node = quick->classes[size].top;
+        while (node != NULL) {
+            node_t *next = node->next;
+            node->next = chain;
+            chain = node;
+            node = next;
+        }
+        quick->cached -= quick->classes[size].count;
+        quick->flushes += quick->classes[size].count;
+        quick->classes[size].top = NULL;
+        quick->classes[size].count = 0;
+    }
+    return chain;
+}
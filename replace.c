@@ -0,0 +1,294 @@
+// replace.c
+//
+// Implementation for the page replacement engines.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/replace.h"
+
+static mem_stats_t replacer_bytes;
+
+/***** Helpers ********/
+
+static void *checked_malloc(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: replace_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static unsigned int hash_key(uint64_t key) {
+    return (unsigned int)((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+/* Returns the map slot holding key, or the empty slot where it would go. */
+static int *find_slot(replacer_t *r, uint64_t key) {
+    unsigned int mask = r->map_capacity - 1;
+    unsigned int i = hash_key(key) & mask;
+
+    while (r->map[i] >= 0 && r->nodes[r->map[i]].key != key)
+        i = (i + 1) & mask;
+    return &r->map[i];
+}
+
+/* Empties a map slot and shifts later entries of the probe run back into the
+ * gap, as pid_map does. */
+static void delete_slot(replacer_t *r, int *slot) {
+    unsigned int mask = r->map_capacity - 1;
+    unsigned int hole = slot - r->map;
+    unsigned int i = hole;
+
+    while (1) {
+        i = (i + 1) & mask;
+        if (r->map[i] < 0)
+            break;
+
+        // Move the entry back only if its home slot is not in (hole, i]
+        unsigned int home = hash_key(r->nodes[r->map[i]].key) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            r->map[hole] = r->map[i];
+            hole = i;
+        }
+    }
+    r->map[hole] = -1;
+}
+
+static void unlink_node(replacer_t *r, int n) {
+    replace_node_t *node = &r->nodes[n];
+
+    if (n == r->hand)
+        r->hand = node->next;
+    r->nodes[node->prev].next = node->next;
+    r->nodes[node->next].prev = node->prev;
+    r->size[node->list]--;
+}
+
+/* Links node n in front of node at, on at's list. */
+static void link_before(replacer_t *r, int n, int at, int list) {
+    replace_node_t *node = &r->nodes[n];
+
+    node->list = list;
+    node->next = at;
+    node->prev = r->nodes[at].prev;
+    r->nodes[node->prev].next = n;
+    r->nodes[at].prev = n;
+    r->size[list]++;
+}
+
+/* Lists run from the most recently used page, after the head, to the least
+ * recently used one, before it. */
+static void push_mru(replacer_t *r, int n, int list) {
+    link_before(r, n, r->nodes[list].next, list);
+}
+
+static int lru(replacer_t *r, int list) {
+    return r->nodes[list].prev;
+}
+
+static int new_node(replacer_t *r, uint64_t key) {
+    int n = r->unused;
+
+    if (n < 0) {  // the lists never hold more than 2 * capacity pages
+        fprintf(stderr, "Error: replacer out of nodes\n");
+        exit(EXIT_FAILURE);
+    }
+    r->unused = r->nodes[n].next;
+    r->nodes[n].key = key;
+    r->nodes[n].referenced = true;
+    *find_slot(r, key) = n;
+    return n;
+}
+
+/* Unlinks node n and forgets its key. */
+static uint64_t drop_node(replacer_t *r, int n) {
+    uint64_t key = r->nodes[n].key;
+
+    unlink_node(r, n);
+    delete_slot(r, find_slot(r, key));
+    r->nodes[n].next = r->unused;
+    r->unused = n;
+    return key;
+}
+
+static bool is_full(const replacer_t *r) {
+    return r->size[REPLACE_T1] + r->size[REPLACE_T2] >= r->capacity;
+}
+
+/* CLOCK: advances the hand past referenced pages, clearing their bits, and
+ * evicts the first page whose bit is clear. */
+static uint64_t clock_evict(replacer_t *r) {
+    while (1) {
+        if (r->hand == REPLACE_T1)
+            r->hand = r->nodes[REPLACE_T1].next;
+        if (!r->nodes[r->hand].referenced)
+            return drop_node(r, r->hand);
+        r->nodes[r->hand].referenced = false;
+        r->hand = r->nodes[r->hand].next;
+    }
+}
+
+/* ARC's REPLACE: evicts the LRU page of T1 into B1 if T1 is above its target
+ * (or at it, for a page found in B2), otherwise the LRU page of T2 into B2. */
+static uint64_t arc_evict(replacer_t *r, bool in_b2) {
+    int t1 = r->size[REPLACE_T1];
+    bool from_t1 = t1 > 0 && ((in_b2 && t1 == r->target) || t1 > r->target || r->size[REPLACE_T2] == 0);
+    int n = lru(r, from_t1 ? REPLACE_T1 : REPLACE_T2);
+
+    unlink_node(r, n);
+    push_mru(r, n, from_t1 ? REPLACE_B1 : REPLACE_B2);
+    return r->nodes[n].key;
+}
+
+/* ARC: makes key resident. See Megiddo and Modha, "ARC: A Self-Tuning, Low
+ * Overhead Replacement Cache"; REPLACE only runs while every frame is taken,
+ * since unmapped pages give theirs back. */
+static bool arc_admit(replacer_t *r, uint64_t key, uint64_t *victim) {
+    int *slot = find_slot(r, key);
+    int n = *slot;
+    bool evict = false;
+
+    if (n >= 0) {  // a ghost: adapt the target towards its list
+        bool in_b2 = r->nodes[n].list == REPLACE_B2;
+        int b1 = r->size[REPLACE_B1], b2 = r->size[REPLACE_B2];
+
+        if (in_b2)
+            r->target -= b1 > b2 ? b1 / b2 : 1;
+        else
+            r->target += b2 > b1 ? b2 / b1 : 1;
+        r->target = r->target < 0 ? 0 : r->target > r->capacity ? r->capacity : r->target;
+
+        if (is_full(r)) {
+            *victim = arc_evict(r, in_b2);
+            evict = true;
+        }
+        unlink_node(r, n);
+        push_mru(r, n, REPLACE_T2);
+        return evict;
+    }
+
+    int l1 = r->size[REPLACE_T1] + r->size[REPLACE_B1];
+    int total = l1 + r->size[REPLACE_T2] + r->size[REPLACE_B2];
+    if (l1 >= r->capacity) {
+        if (r->size[REPLACE_T1] < r->capacity) {
+            drop_node(r, lru(r, REPLACE_B1));
+            if (is_full(r)) {
+                *victim = arc_evict(r, false);
+                evict = true;
+            }
+        }
+        else {  // T1 alone fills every frame: its LRU page is not remembered
+            *victim = drop_node(r, lru(r, REPLACE_T1));
+            evict = true;
+        }
+    }
+    else if (total >= r->capacity) {
+        if (total >= 2 * r->capacity)
+            drop_node(r, lru(r, REPLACE_B2));
+        if (is_full(r)) {
+            *victim = arc_evict(r, false);
+            evict = true;
+        }
+    }
+    push_mru(r, new_node(r, key), REPLACE_T1);
+    return evict;
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: replace_alloc
+ * -----------------------
+ * Allocates a replacer for capacity frames.
+ *
+ * Description:
+ *  ARC remembers up to capacity evicted pages besides the resident ones, so
+ *  2 * capacity nodes are set aside up front, and the map is kept at most a
+ *  quarter full.
+ */
+replacer_t *replace_alloc(replace_policy_t policy, int capacity) {
+    replacer_t *r = checked_malloc(sizeof(replacer_t));
+
+    r->policy = policy;
+    r->capacity = capacity;
+    r->node_count = REPLACE_LISTS + 2 * capacity;
+    r->nodes = checked_malloc(r->node_count * sizeof(replace_node_t));
+    for (int l = 0; l < REPLACE_LISTS; l++) {
+        r->nodes[l].prev = r->nodes[l].next = l;
+        r->nodes[l].list = l;
+        r->size[l] = 0;
+    }
+    r->unused = -1;
+    for (int n = r->node_count - 1; n >= REPLACE_LISTS; n--) {
+        r->nodes[n].next = r->unused;
+        r->unused = n;
+    }
+    r->target = 0;
+    r->hand = REPLACE_T1;
+
+    r->map_capacity = 1;
+    while (r->map_capacity < 2 * r->node_count)
+        r->map_capacity *= 2;
+    r->map = checked_malloc(r->map_capacity * sizeof(int));
+    for (int i = 0; i < r->map_capacity; i++)
+        r->map[i] = -1;
+
+    mem_stats_track(&replacer_bytes, sizeof(replacer_t) + r->node_count * sizeof(replace_node_t) +
+                                     r->map_capacity * sizeof(int));
+    return r;
+}
+
+void replace_free(replacer_t *r) {
+    if (r != NULL) {
+        mem_stats_track(&replacer_bytes, -(long)(sizeof(replacer_t) + r->node_count * sizeof(replace_node_t) +
+                                                 r->map_capacity * sizeof(int)));
+        free(r->nodes);
+        free(r->map);
+        free(r);
+    }
+}
+
+void replace_mem_stats(mem_stats_t *stats) {
+    stats->in_use += replacer_bytes.in_use;
+    stats->peak += replacer_bytes.peak;
+}
+
+void replace_touch(replacer_t *r, uint64_t key) {
+    int n = *find_slot(r, key);
+
+    if (n < 0)
+        return;
+    if (r->policy == REPLACE_CLOCK) {
+        r->nodes[n].referenced = true;
+    }
+    else {  // LRU: to the front of T1; ARC: to the front of T2
+        unlink_node(r, n);
+        push_mru(r, n, r->policy == REPLACE_LRU ? REPLACE_T1 : REPLACE_T2);
+    }
+}
+
+bool replace_admit(replacer_t *r, uint64_t key, uint64_t *victim) {
+    bool evict = false;
+
+    if (r->policy == REPLACE_ARC)
+        return arc_admit(r, key, victim);
+
+    if (is_full(r)) {
+        *victim = r->policy == REPLACE_CLOCK ? clock_evict(r) : drop_node(r, lru(r, REPLACE_T1));
+        evict = true;
+    }
+    if (r->policy == REPLACE_CLOCK)  // behind the hand, the last page it reaches
+        link_before(r, new_node(r, key), r->hand, REPLACE_T1);
+    else
+        push_mru(r, new_node(r, key), REPLACE_T1);
+    return evict;
+}
+
+void replace_remove(replacer_t *r, uint64_t key) {
+    int n = *find_slot(r, key);
+
+    if (n >= 0)
+        drop_node(r, n);
+}
@@ -0,0 +1,440 @@
+// soa.c
+//
+// Implementation for the structure-of-arrays free block store.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "./Headers/soa.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOA_HAVE_X86 1
+#endif
+
+#define SOA_INITIAL_CAPACITY 64
+
+static soa_store_t *live_stores = NULL;
+static mem_stats_t store_bytes;
+
+/***** Scalar Kernels ********/
+
+static int first_fit_scalar(const int *size, int n, int request) {
+    for (int i = 0; i < n; i++) {
+        if (size[i] >= request)
+            return i;
+    }
+    return -1;
+}
+
+static int best_fit_scalar(const int *size, int n, int request) {
+    int best = -1;
+    for (int i = 0; i < n; i++) {
+        if (size[i] >= request && (best < 0 || size[i] < size[best]))
+            best = i;
+    }
+    return best;
+}
+
+static int worst_fit_scalar(const int *size, int n, int request) {
+    int worst = -1;
+    for (int i = 0; i < n; i++) {
+        if (worst < 0 || size[i] > size[worst])
+            worst = i;
+    }
+    return (worst >= 0 && size[worst] >= request) ? worst : -1;
+}
+
+/* Returns the first index at or after from whose size equals value. */
+static int find_equal_scalar(const int *size, int from, int n, int value) {
+    for (int i = from; i < n; i++) {
+        if (size[i] == value)
+            return i;
+    }
+    return -1;
+}
+
+#ifdef SOA_HAVE_X86
+
+/***** SSE4.1 Kernels ********/
+
+__attribute__((target("sse4.1")))
+static int find_equal_sse(const int *size, int n, int value) {
+    __m128i v = _mm_set1_epi32(value);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(size + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(s, v)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return find_equal_scalar(size, i, n, value);
+}
+
+__attribute__((target("sse4.1")))
+static int first_fit_sse(const int *size, int n, int request) {
+    __m128i limit = _mm_set1_epi32(request - 1);
+    int i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(size + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(s, limit)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    int rest = first_fit_scalar(size + i, n - i, request);
+    return rest < 0 ? -1 : i + rest;
+}
+
+__attribute__((target("sse4.1")))
+static int best_fit_sse(const int *size, int n, int request) {
+    __m128i limit = _mm_set1_epi32(request - 1);
+    __m128i none = _mm_set1_epi32(INT_MAX);
+    __m128i best = none;
+    int i = 0, lanes[4], min = INT_MAX, found = 0;
+
+    // Pass 1: smallest qualifying size, non-qualifying lanes read as INT_MAX
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(size + i));
+        __m128i fits = _mm_cmpgt_epi32(s, limit);
+        found |= _mm_movemask_ps(_mm_castsi128_ps(fits));
+        best = _mm_min_epi32(best, _mm_blendv_epi8(none, s, fits));
+    }
+    _mm_storeu_si128((__m128i *)lanes, best);
+    for (int l = 0; l < 4; l++)
+        min = lanes[l] < min ? lanes[l] : min;
+    for (; i < n; i++) {
+        if (size[i] >= request) {
+            found = 1;
+            if (size[i] < min)
+                min = size[i];
+        }
+    }
+
+    // Pass 2: first entry with that size
+    return found ? find_equal_sse(size, n, min) : -1;
+}
+
+__attribute__((target("sse4.1")))
+static int worst_fit_sse(const int *size, int n, int request) {
+    __m128i worst = _mm_set1_epi32(INT_MIN);
+    int i = 0, lanes[4], max = INT_MIN;
+
+    if (n == 0)
+        return -1;
+
+    for (; i + 4 <= n; i += 4)
+        worst = _mm_max_epi32(worst, _mm_loadu_si128((const __m128i *)(size + i)));
+    _mm_storeu_si128((__m128i *)lanes, worst);
+    for (int l = 0; l < 4; l++)
+        max = lanes[l] > max ? lanes[l] : max;
+    for (; i < n; i++)
+        max = size[i] > max ? size[i] : max;
+
+    return max >= request ? find_equal_sse(size, n, max) : -1;
+}
+
+/***** AVX2 Kernels ********/
+
+__attribute__((target("avx2")))
+static int find_equal_avx2(const int *size, int n, int value) {
+    __m256i v = _mm256_set1_epi32(value);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(size + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(s, v)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return find_equal_scalar(size, i, n, value);
+}
+
+__attribute__((target("avx2")))
+static int first_fit_avx2(const int *size, int n, int request) {
+    __m256i limit = _mm256_set1_epi32(request - 1);
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(size + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(s, limit)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    int rest = first_fit_scalar(size + i, n - i, request);
+    return rest < 0 ? -1 : i + rest;
+}
+
+/* Reduces the 8 lanes of v to their minimum (is_min) or maximum. */
+__attribute__((target("avx2")))
+static int reduce_avx2(__m256i v, int is_min) {
+    int lanes[8], r;
+    _mm256_storeu_si256((__m256i *)lanes, v);
+    r = lanes[0];
+    for (int l = 1; l < 8; l++) {
+        if (is_min ? lanes[l] < r : lanes[l] > r)
+            r = lanes[l];
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static int best_fit_avx2(const int *size, int n, int request) {
+    __m256i limit = _mm256_set1_epi32(request - 1);
+    __m256i none = _mm256_set1_epi32(INT_MAX);
+    __m256i best = none;
+    int i = 0, min, found = 0;
+
+    // Pass 1: smallest qualifying size, non-qualifying lanes read as INT_MAX
+    for (; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(size + i));
+        __m256i fits = _mm256_cmpgt_epi32(s, limit);
+        found |= _mm256_movemask_ps(_mm256_castsi256_ps(fits));
+        best = _mm256_min_epi32(best, _mm256_blendv_epi8(none, s, fits));
+    }
+    min = reduce_avx2(best, 1);
+    for (; i < n; i++) {
+        if (size[i] >= request) {
+            found = 1;
+            if (size[i] < min)
+                min = size[i];
+        }
+    }
+
+    // Pass 2: first entry with that size
+    return found ? find_equal_avx2(size, n, min) : -1;
+}
+
+__attribute__((target("avx2")))
+static int worst_fit_avx2(const int *size, int n, int request) {
+    __m256i worst = _mm256_set1_epi32(INT_MIN);
+    int i = 0, max;
+
+    if (n == 0)
+        return -1;
+
+    for (; i + 8 <= n; i += 8)
+        worst = _mm256_max_epi32(worst, _mm256_loadu_si256((const __m256i *)(size + i)));
+    max = reduce_avx2(worst, 0);
+    for (; i < n; i++)
+        max = size[i] > max ? size[i] : max;
+
+    return max >= request ? find_equal_avx2(size, n, max) : -1;
+}
+
+#endif /* SOA_HAVE_X86 */
+
+/***** Helpers ********/
+
+static void *grow_array(void *array, int capacity) {
+    void *grown = realloc(array, capacity * sizeof(int));
+    if (grown == NULL) {
+        fprintf(stderr, "Error: soa_push failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+static void set_kernels(soa_store_t *store, soa_isa_t isa) {
+    store->isa = SOA_SCALAR;
+    store->first_fit = first_fit_scalar;
+    store->best_fit = best_fit_scalar;
+    store->worst_fit = worst_fit_scalar;
+
+#ifdef SOA_HAVE_X86
+    if (isa == SOA_AVX2 && __builtin_cpu_supports("avx2")) {
+        store->isa = SOA_AVX2;
+        store->first_fit = first_fit_avx2;
+        store->best_fit = best_fit_avx2;
+        store->worst_fit = worst_fit_avx2;
+    }
+    else if (isa >= SOA_SSE && __builtin_cpu_supports("sse4.1")) {
+        store->isa = SOA_SSE;
+        store->first_fit = first_fit_sse;
+        store->best_fit = best_fit_sse;
+        store->worst_fit = worst_fit_sse;
+    }
+#else
+    (void)isa;
+#endif
+}
+
+/* Orders (start, size) pairs by start for qsort. */
+static int compare_pair_start(const void *a, const void *b) {
+    const int *x = a, *y = b;
+    return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+/***** Function Definitions ********/
+
+soa_isa_t soa_best_isa() {
+#ifdef SOA_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SOA_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return SOA_SSE;
+#endif
+    return SOA_SCALAR;
+}
+
+/**
+ * Function: soa_alloc
+ * -------------------
+ * Allocates an empty store whose kernels use isa, or the widest narrower
+ * instruction set the CPU supports. Exits with a failure status if malloc fails.
+ */
+soa_store_t *soa_alloc(soa_isa_t isa) {
+    soa_store_t *store = malloc(sizeof(soa_store_t));
+    if (store == NULL) {
+        fprintf(stderr, "Error: soa_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    store->capacity = SOA_INITIAL_CAPACITY;
+    store->count = 0;
+    store->rover = 0;
+    store->start = grow_array(NULL, store->capacity);
+    store->size = grow_array(NULL, store->capacity);
+    mem_stats_track(&store_bytes, sizeof(soa_store_t) + 2 * store->capacity * sizeof(int));
+#ifdef SOA_HAVE_X86
+    __builtin_cpu_init();
+#endif
+    set_kernels(store, isa);
+
+    store->prev = NULL;
+    store->next = live_stores;
+    if (live_stores != NULL)
+        live_stores->prev = store;
+    live_stores = store;
+    return store;
+}
+
+void soa_free(soa_store_t *store) {
+    if (store != NULL) {
+        if (store->prev != NULL)
+            store->prev->next = store->next;
+        else
+            live_stores = store->next;
+        if (store->next != NULL)
+            store->next->prev = store->prev;
+
+        mem_stats_track(&store_bytes, -(long)(sizeof(soa_store_t) + 2 * store->capacity * sizeof(int)));
+        free(store->start);
+        free(store->size);
+        free(store);
+    }
+}
+
+void soa_release_all() {
+    while (live_stores != NULL)
+        soa_free(live_stores);
+}
+
+void soa_mem_stats(mem_stats_t *stats) {
+    stats->in_use += store_bytes.in_use;
+    stats->peak += store_bytes.peak;
+}
+
+void soa_push(soa_store_t *store, int start, int end) {
+    if (store->count == store->capacity) {
+        store->capacity *= 2;
+        store->start = grow_array(store->start, store->capacity);
+        store->size = grow_array(store->size, store->capacity);
+        mem_stats_track(&store_bytes, (long)store->capacity * sizeof(int)); // 2 arrays, half each
+    }
+    store->start[store->count] = start;
+    store->size[store->count] = end - start + 1;
+    store->count++;
+}
+
+void soa_remove(soa_store_t *store, int i) {
+    int tail = store->count - i - 1;
+    memmove(store->start + i, store->start + i + 1, tail * sizeof(int));
+    memmove(store->size + i, store->size + i + 1, tail * sizeof(int));
+    store->count--;
+
+    if (i < store->rover)
+        store->rover--;
+    if (store->rover >= store->count)
+        store->rover = 0;
+}
+
+int soa_find_start(soa_store_t *store, int start) {
+#ifdef SOA_HAVE_X86
+    if (store->isa == SOA_AVX2)
+        return find_equal_avx2(store->start, store->count, start);
+    if (store->isa == SOA_SSE)
+        return find_equal_sse(store->start, store->count, start);
+#endif
+    return find_equal_scalar(store->start, 0, store->count, start);
+}
+
+int soa_find_fit(soa_store_t *store, int request, int policy) {
+    if (policy == 1)
+        return store->first_fit(store->size, store->count, request);
+    if (policy == 2)
+        return store->best_fit(store->size, store->count, request);
+    if (policy == 3)
+        return store->worst_fit(store->size, store->count, request);
+    if (policy == 4) {
+        int r = store->rover;
+        int i = store->first_fit(store->size + r, store->count - r, request);
+        if (i >= 0)
+            return r + i;
+        return store->first_fit(store->size, r, request);
+    }
+    return -1;
+}
+
+/**
+ * Function: soa_coalesce
+ * ----------------------
+ * Sorts the store by start address and merges adjacent blocks in O(n log n).
+ */
+void soa_coalesce(soa_store_t *store) {
+    int n = store->count, kept = 0;
+    int (*pairs)[2];
+
+    if (n == 0)
+        return;
+
+    int rover_start = store->start[store->rover];
+
+    pairs = malloc(n * sizeof(*pairs));
+    if (pairs == NULL) {
+        fprintf(stderr, "Error: soa_coalesce failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        pairs[i][0] = store->start[i];
+        pairs[i][1] = store->size[i];
+    }
+    qsort(pairs, n, sizeof(*pairs), compare_pair_start);
+
+    store->start[0] = pairs[0][0];
+    store->size[0] = pairs[0][1];
+    for (int i = 1; i < n; i++) {
+        if (store->start[kept] + store->size[kept] == pairs[i][0]) {
+            store->size[kept] += pairs[i][1]; // physically adjacent, merge
+        }
+        else {
+            kept++;
+            store->start[kept] = pairs[i][0];
+            store->size[kept] = pairs[i][1];
+        }
+    }
+    store->count = kept + 1;
+    free(pairs);
+
+    store->rover = 0;
+    for (int i = 0; i < store->count; i++) {
+        if (store->start[i] <= rover_start && rover_start < store->start[i] + store->size[i]) {
+            store->rover = i;
+            break;
+        }
+    }
+}
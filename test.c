@@ -1,6 +1,14 @@
 // test.c
 #include "./Headers/test.h"
 #include "./Headers/mmu.h"
+#include "./Headers/avl.h"
+#include "./Headers/soa.h"
+#include "./Headers/buddy.h"
+#include "./Headers/tlsf.h"
+#include "./Headers/quick.h"
+#include "./Headers/paging.h"
+#include "./Headers/pidmap.h"
+#include "./Headers/tlb.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,6 +21,28 @@ void run_all_tests() {
     test_remove_block_from_freelist();
     test_allocate_memory_edge_cases();
     test_deallocate_memory_edge_cases();
+    test_allocate_memory_indexed();
+    test_deallocate_memory_eager();
+    test_deallocate_memory_pid_index();
+    test_pool_recycling();
+    test_intrusive_nodes();
+    test_allocate_memory_soa();
+    test_trace_reader();
+    test_trace_binary();
+    test_free_list_summary();
+    test_allocate_memory_next_fit();
+    test_buddy_engine();
+    test_tlsf_engine();
+    test_quick_lists();
+    test_compact_memory();
+    test_allocate_memory_lazy();
+    test_allocate_memory_batch();
+    test_resize_memory();
+    test_deallocate_memory_pid_chain();
+    test_query_address();
+    test_paging_engine();
+    test_tlb();
+    test_page_replacement();
     printf("All tests passed.\n");
 }
 
@@ -22,7 +52,7 @@ void test_allocate_memory() {
     int policy = 1; // Testing with FIFO policy
 
     // Initial conditions
-    block_t *initial_block = malloc(sizeof(block_t));
+    block_t *initial_block = block_alloc();
     initial_block->pid = 0;
     initial_block->start = 0;
     initial_block->end = 1000;
@@ -45,7 +75,7 @@ void test_deallocate_memory() {
     int policy = 1; // Testing with FIFO policy
 
     // Setup allocated block
-    block_t *allocated_block = malloc(sizeof(block_t));
+    block_t *allocated_block = block_alloc();
     allocated_block->pid = 1;
     allocated_block->start = 0;
     allocated_block->end = 499;
@@ -66,9 +96,9 @@ void test_coalese_memory() {
     list_t *list = list_alloc();
 
     // Add adjacent blocks
-    block_t *block1 = malloc(sizeof(block_t));
+    block_t *block1 = block_alloc();
     block1->pid = 0; block1->start = 0; block1->end = 499;
-    block_t *block2 = malloc(sizeof(block_t));
+    block_t *block2 = block_alloc();
     block2->pid = 0; block2->start = 500; block2->end = 999;
     list_add_to_back(list, block1);
     list_add_to_back(list, block2);
@@ -85,7 +115,7 @@ void test_coalese_memory() {
 
 void test_list_add_to_freelist() {
     list_t *freelist = list_alloc();
-    block_t *block = malloc(sizeof(block_t));
+    block_t *block = block_alloc();
     block->pid = 0; block->start = 0; block->end = 499;
 
     // Test adding to free list
@@ -100,7 +130,7 @@ void test_list_add_to_freelist() {
 
 void test_remove_block_from_freelist() {
     list_t *freelist = list_alloc();
-    block_t *block = malloc(sizeof(block_t));
+    block_t *block = block_alloc();
     block->pid = 0; block->start = 0; block->end = 499;
     list_add_to_back(freelist, block);
 
@@ -122,7 +152,7 @@ void test_allocate_memory_edge_cases() {
 
     // Test allocation with insufficient block size
     list_t *freelist = list_alloc();
-    block_t *small_block = malloc(sizeof(block_t));
+    block_t *small_block = block_alloc();
     small_block->pid = 0; small_block->start = 0; small_block->end = 100;
     list_add_to_back(freelist, small_block);
     allocate_memory(freelist, alloc_list, 1, 500, 1); // FIFO policy
@@ -148,7 +178,999 @@ void test_deallocate_memory_edge_cases() {
     printf("test_deallocate_memory_edge_cases passed.\n");
 }
 
+void test_allocate_memory_indexed() {
+    int sizes[] = {300, 100, 200};
+    int starts[] = {0, 400, 600};
+
+    for (int policy = 2; policy <= 3; policy++) {
+        list_t *freelist = list_alloc();
+        list_t *alloclist = list_alloc();
+
+        for (int i = 0; i < 3; i++) {
+            block_t *blk = block_alloc();
+            blk->pid = 0; blk->start = starts[i]; blk->end = starts[i] + sizes[i] - 1;
+            list_add_to_back(freelist, blk);
+        }
+        list_index_by_size(freelist, policy);
+
+        // Best fit takes the 200 block at 600, worst fit the 300 block at 0
+        allocate_memory(freelist, alloclist, 1, 150, policy);
+        assert(alloclist->length == 1);
+        assert(alloclist->head->blk->start == (policy == 2 ? 600 : 0));
+        assert(freelist->length == 3);
+
+        // The list stays in index order
+        for (node_t *n = freelist->head; n->next != NULL; n = n->next) {
+            int a = n->blk->end - n->blk->start, b = n->next->blk->end - n->next->blk->start;
+            assert(policy == 2 ? a <= b : a >= b);
+        }
+
+        block_t probe = {0, 400, 499};
+        remove_block_from_freelist(freelist, &probe);
+        assert(freelist->length == 2);
+
+        list_free(freelist);
+        list_free(alloclist);
+    }
+
+    // Between equal holes the index picks the one the unindexed list would:
+    // best fit the last freed, worst fit the first
+    for (int policy = 2; policy <= 3; policy++) {
+        int freed[] = {200, 0, 400};
+        int picked[2];
+
+        for (int indexed = 0; indexed <= 1; indexed++) {
+            list_t *freelist = list_alloc();
+            list_t *alloclist = list_alloc();
+
+            if (indexed)
+                list_index_by_size(freelist, policy);
+            for (int i = 0; i < 3; i++) {
+                block_t *blk = block_alloc();
+                blk->pid = 0; blk->start = freed[i]; blk->end = freed[i] + 99;
+                list_add_to_freelist(freelist, blk, policy);
+            }
+            allocate_memory(freelist, alloclist, 1, 100, policy);
+            picked[indexed] = alloclist->head->blk->start;
+
+            list_free(freelist);
+            list_free(alloclist);
+        }
+        assert(picked[0] == (policy == 2 ? 400 : 200));
+        assert(picked[1] == picked[0]);
+    }
+
+    // One of many equal holes is found by its stamp, or by its start
+    for (int by_address = 0; by_address <= 1; by_address++) {
+        list_t *freelist = list_alloc();
+        node_t *node = NULL;
+
+        list_index_by_size(freelist, 2);
+        if (by_address)
+            list_index_by_address(freelist);
+        for (int i = 0; i < 64; i++) {
+            block_t *blk = block_alloc();
+            blk->pid = 0; blk->start = i * 20; blk->end = i * 20 + 9;
+            list_add_to_freelist(freelist, blk, 2);
+            if (i == 37)
+                node = freelist->head;  // best fit puts it first among its equals
+        }
+        assert(node->blk->start == 740);
+        assert(avl_find(freelist->size_index, node->blk) == node);
+
+        block_t probe = {0, 740, 749};
+        remove_block_from_freelist(freelist, &probe);
+        assert(freelist->length == 63 && freelist->size_index->count == 63);
+        for (node_t *n = freelist->head; n != NULL; n = n->next)
+            assert(n->blk->start != 740);
+        list_free(freelist);
+    }
+    printf("test_allocate_memory_indexed passed.\n");
+}
+
+void test_deallocate_memory_eager() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 2; // Best fit, also size indexed
+
+    // Free 0-99 and 200-299 around an allocated 100-199
+    block_t *left = block_alloc();
+    left->pid = 0; left->start = 0; left->end = 99;
+    block_t *right = block_alloc();
+    right->pid = 0; right->start = 200; right->end = 299;
+    block_t *used = block_alloc();
+    used->pid = 7; used->start = 100; used->end = 199;
+    list_add_to_back(freelist, left);
+    list_add_to_back(freelist, right);
+    list_add_to_back(alloclist, used);
+    list_index_by_size(freelist, policy);
+    list_index_by_address(freelist);
+
+    // Freeing the middle block merges all three right away
+    deallocate_memory(alloclist, freelist, 7, policy);
+    assert(alloclist->length == 0);
+    assert(freelist->length == 1);
+    assert(freelist->head->blk->start == 0 && freelist->head->blk->end == 299);
+    assert(freelist->head->blk->pid == 0);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_deallocate_memory_eager passed.\n");
+}
+
+void test_deallocate_memory_pid_index() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1;
+
+    list_index_by_pid(alloclist);
+
+    // PID 3 holds two blocks; the lower one is freed first
+    int pids[] = {3, 4, 3};
+    for (int i = 0; i < 3; i++) {
+        block_t *blk = block_alloc();
+        blk->pid = pids[i]; blk->start = i * 100; blk->end = i * 100 + 99;
+        list_add_ascending_by_address(alloclist, blk);
+    }
+    assert(list_is_in_by_pid(alloclist, 4));
+    assert(list_get_node_by_pid(alloclist, 3)->blk->start == 0);
+
+    deallocate_memory(alloclist, freelist, 3, policy);
+    assert(freelist->length == 1 && freelist->head->blk->start == 0);
+    assert(list_get_node_by_pid(alloclist, 3)->blk->start == 200);
+
+    deallocate_memory(alloclist, freelist, 3, policy);
+    assert(!list_is_in_by_pid(alloclist, 3));
+    assert(list_get_index_of_by_Pid(alloclist, 3) == -1);
+    assert(list_get_index_of_by_Pid(alloclist, 4) == 0);
+    assert(alloclist->length == 1 && freelist->length == 2);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_deallocate_memory_pid_index passed.\n");
+}
+
+void test_pool_recycling() {
+    list_t *list = list_alloc();
+    block_t *block = block_alloc();
+    block->pid = 0; block->start = 0; block->end = 99;
+
+    // A freed block is handed out again before the pool grows
+    list_add_to_back(list, block);
+    block_t *removed = list_remove_from_front(list);
+    block_free(removed);
+    assert(block_alloc() == block);
+
+    // One bulk release drops the list and everything still on it
+    list_add_to_back(list, block);
+    list_release_all();
+    printf("test_pool_recycling passed.\n");
+}
+
+void test_intrusive_nodes() {
+    list_t *list = list_alloc();
+    block_t *a = block_alloc();
+    block_t *b = block_alloc();
+    a->pid = 0; a->start = 100; a->end = 199;
+    b->pid = 0; b->start = 0; b->end = 99;
+
+    // The nodes linking the blocks are the ones embedded in them
+    list_add_ascending_by_address(list, a);
+    list_add_ascending_by_address(list, b);
+    assert(list->head == &b->link && list->tail == &a->link);
+    assert(list->head->next->blk == a && list->tail->prev->blk == b);
+
+    // Removing a block keeps it, so it can move to another list
+    assert(list_remove_from_back(list) == a);
+    assert(a->link.next == NULL && a->link.prev == NULL);
+    list_add_to_front(list, a);
+    assert(list->head->blk == a && list->length == 2);
+
+    list_free(list);
+    printf("test_intrusive_nodes passed.\n");
+}
+
+void test_allocate_memory_soa() {
+    // Sizes 10, 20, ..., 200 at 0, 100, ..., 1900, then 120 and 30 again.
+    // For 115 bytes first fit and best fit take the first 120 block (ties go
+    // to the lower store index), worst fit the 200 block.
+    int expected_start[] = {1100, 1100, 1900};
+
+    for (int isa = SOA_SCALAR; isa <= SOA_AVX2; isa++) {
+        for (int policy = 1; policy <= 3; policy++) {
+            list_t *freelist = list_alloc();
+            list_t *alloclist = list_alloc();
+            list_use_soa(freelist, isa);
+
+            for (int i = 0; i < 22; i++) {
+                block_t *blk = block_alloc();
+                int size = i < 20 ? (i + 1) * 10 : (i == 20 ? 120 : 30);
+                blk->pid = 0; blk->start = i * 100; blk->end = blk->start + size - 1;
+                list_add_to_freelist(freelist, blk, policy);
+            }
+
+            allocate_memory(freelist, alloclist, 1, 115, policy);
+            assert(alloclist->length == 1);
+            assert(alloclist->head->blk->start == expected_start[policy - 1]);
+            assert(freelist->length == 22); // remainder appended
+
+            allocate_memory(freelist, alloclist, 2, 1000, policy);
+            assert(alloclist->length == 1 && "Allocation should fail without a large enough block");
+
+            list_free(freelist);
+            list_free(alloclist);
+        }
+    }
+    printf("test_allocate_memory_soa passed.\n");
+}
+
+void test_trace_reader() {
+    const char *path = "test_trace.tmp";
+    FILE *f = fopen(path, "w");
+    assert(f != NULL);
+    fprintf(f, "5000\n");
+    for (int i = 1; i <= 100000; i++)  // several read blocks worth of operations
+        fprintf(f, "%d %d\n", i, i % 7);
+    fprintf(f, "-99999 0\n-42 0");   // no newline after the last entry
+    fclose(f);
+
+    trace_reader_t *trace = trace_open(path);
+    int op[TRACE_OP_WORDS], n = 0;
+    assert(trace != NULL && trace->partition_size == 5000);
+    while (trace_next(trace, op)) {
+        n++;
+        if (n <= 100000)
+            assert(op[0] == n && op[1] == n % 7);
+    }
+    assert(n == 100002 && op[0] == -42 && op[1] == 0);
+    assert(!trace->error);
+    trace_close(trace);
+
+    // The int range is accepted, anything beyond it is malformed
+    f = fopen(path, "w");
+    assert(f != NULL);
+    fprintf(f, "5000\n2147483647 -2147483648\n1 2147483648\n");
+    fclose(f);
+    trace = trace_open(path);
+    assert(trace != NULL && trace_next(trace, op));
+    assert(op[0] == 2147483647 && op[1] == -2147483647 - 1);
+    assert(!trace_next(trace, op) && trace->error);
+    trace_close(trace);
+
+    assert(trace_open("no/such/trace.txt") == NULL);
+    remove(path);
+    printf("test_trace_reader passed.\n");
+}
+
+void test_trace_binary() {
+    const char *text_path = "test_trace.tmp", *bin_path = "test_trace.bin.tmp";
+    FILE *f = fopen(text_path, "w");
+    assert(f != NULL);
+    fprintf(f, "4096\n1 100\n2 -5\n-99999 0\n-99998 1 300\n-1 0\n");
+    fclose(f);
+
+    assert(trace_convert(text_path, bin_path) == 5);
+
+    int expected[5][3] = {{1, 100, 0}, {2, -5, 0}, {-99999, 0, 0}, {-99998, 1, 300}, {-1, 0, 0}};
+    trace_reader_t *trace = trace_open(bin_path);
+    int op[TRACE_OP_WORDS], n = 0;
+    assert(trace != NULL && trace->map != NULL && trace->partition_size == 4096);
+    while (trace_next(trace, op)) {
+        assert(op[0] == expected[n][0] && op[1] == expected[n][1] && op[2] == expected[n][2]);
+        n++;
+    }
+    assert(n == 5 && !trace->error);
+    trace_close(trace);
+
+    // A header claiming more records than the file holds is rejected
+    f = fopen(bin_path, "r+b");
+    fseek(f, 16, SEEK_SET);
+    fputc(6, f);
+    fclose(f);
+    trace = trace_open(bin_path);
+    assert(trace != NULL && trace->error && !trace_next(trace, op));
+    trace_close(trace);
+
+    // A write that fails (a full device) or a malformed text trace is an error
+    assert(trace_convert(text_path, "/dev/full") == -2);
+    f = fopen(text_path, "a");
+    fprintf(f, "3 x\n");
+    fclose(f);
+    assert(trace_convert(text_path, bin_path) == -2);
+    trace = trace_open(bin_path);  // without a header it is not a binary trace
+    assert(trace != NULL && trace->map == NULL);
+    trace_close(trace);
+
+    remove(text_path);
+    remove(bin_path);
+    printf("test_trace_binary passed.\n");
+}
+
+void test_free_list_summary() {
+    list_t *freelist = list_alloc();
+    int free_bytes, holes, largest;
+
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    assert(free_bytes == 0 && holes == 0 && largest == 0);
+
+    int extents[3][2] = {{0, 99}, {200, 209}, {300, 799}};
+    for (int i = 0; i < 3; i++) {
+        block_t *blk = block_alloc();
+        blk->pid = 0;
+        blk->start = extents[i][0];
+        blk->end = extents[i][1];
+        list_add_to_back(freelist, blk);
+    }
+
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    assert(free_bytes == 610 && holes == 3 && largest == 500);
+
+    list_free(freelist);
+    printf("test_free_list_summary passed.\n");
+}
+
+void test_allocate_memory_next_fit() {
+    int policy = 4; // Testing with Next Fit policy
+
+    // Free blocks [0, 99], [200, 299], [400, 499] in a plain list, in a store
+    // and in an address indexed list
+    for (int variant = 0; variant <= 2; variant++) {
+        list_t *freelist = list_alloc();
+        list_t *alloclist = list_alloc();
+        if (variant == 1)
+            list_use_soa(freelist, SOA_SCALAR);
+        if (variant == 2)
+            list_index_by_address(freelist);
+
+        for (int i = 0; i < 3; i++) {
+            block_t *blk = block_alloc();
+            blk->pid = 0;
+            blk->start = 200 * i;
+            blk->end = 200 * i + 99;
+            list_add_to_freelist(freelist, blk, policy);
+        }
+
+        allocate_memory(freelist, alloclist, 1, 80, policy);  // [0, 79], rover on [80, 99]
+        allocate_memory(freelist, alloclist, 2, 50, policy);  // too big for [80, 99]: [200, 249]
+        allocate_memory(freelist, alloclist, 3, 10, policy);  // resumes at [250, 299], not at the head
+        assert(list_get_node_by_pid(alloclist, 3)->blk->start == 250);
+
+        freelist = coalese_memory(freelist);                   // the rover follows its block
+        allocate_memory(freelist, alloclist, 4, 10, policy);
+        assert(list_get_node_by_pid(alloclist, 4)->blk->start == 260);
+
+        allocate_memory(freelist, alloclist, 5, 30, policy);  // uses up [270, 299]
+        allocate_memory(freelist, alloclist, 6, 20, policy);  // next is [400, 499]
+        assert(list_get_node_by_pid(alloclist, 6)->blk->start == 400);
+        assert(freelist->length == 2);
+
+        list_free(freelist);
+        list_free(alloclist);
+    }
+    printf("test_allocate_memory_next_fit passed.\n");
+}
+
+void test_buddy_engine() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 5; // Testing with the buddy engine
+    buddy_stats_t stats;
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+
+    buddy_init(freelist);   // 1000 = 512 + 256 + 128 + 64 + 32 + 8
+    assert(freelist->length == 6);
+    assert(freelist->head->blk->end == 511 && freelist->tail->blk->start == 992);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // the 128 block at 768
+    allocate_memory(freelist, alloclist, 2, 10, policy);   // lower half of the 32 block at 960
+    assert(list_get_node_by_pid(alloclist, 1)->blk->start == 768);
+    assert(list_get_node_by_pid(alloclist, 1)->blk->end == 867);
+    assert(list_get_node_by_pid(alloclist, 2)->blk->start == 960);
+    assert(freelist->length == 5);
+
+    buddy_stats(alloclist, &stats);
+    assert(stats.blocks == 2 && stats.requested == 110 && stats.reserved == 144);
+
+    allocate_memory(freelist, alloclist, 3, 600, policy);  // larger than any block
+    assert(alloclist->length == 2);
+    allocate_memory(freelist, alloclist, 4, (1 << 30) + 1, policy);  // beyond any order
+    assert(alloclist->length == 2 && freelist->length == 5);
+
+    // Freeing pid 2 merges [960, 975] with its buddy [976, 991] again
+    deallocate_memory(alloclist, freelist, 2, policy);
+    deallocate_memory(alloclist, freelist, 1, policy);
+    assert(freelist->length == 6 && alloclist->length == 0);
+    for (node_t *curr = freelist->head; curr != NULL; curr = curr->next) {
+        int size = curr->blk->end - curr->blk->start + 1;
+        assert((size & (size - 1)) == 0 && curr->blk->start % size == 0);
+    }
+
+    list_free(freelist);
+    list_free(alloclist);
+
+    // Between blocks of the same order the lowest address goes first
+    freelist = list_alloc();
+    alloclist = list_alloc();
+    partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 64 - 1;
+    list_add_to_back(freelist, partition);
+    buddy_init(freelist);
+    for (int pid = 1; pid <= 4; pid++)
+        allocate_memory(freelist, alloclist, pid, 16, policy);
+    deallocate_memory(alloclist, freelist, 1, policy);  // [0, 15]
+    deallocate_memory(alloclist, freelist, 3, policy);  // [32, 47], freed last
+    allocate_memory(freelist, alloclist, 5, 16, policy);
+    assert(list_get_node_by_pid(alloclist, 5)->blk->start == 0);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_buddy_engine passed.\n");
+}
+
+void test_tlsf_engine() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 6; // Testing with the TLSF engine
+
+    // Two free ranges with [100, 199] in use in between
+    int extents[2][2] = {{0, 99}, {200, 999}};
+    for (int i = 0; i < 2; i++) {
+        block_t *blk = block_alloc();
+        blk->pid = 0;
+        blk->start = extents[i][0];
+        blk->end = extents[i][1];
+        list_add_to_back(freelist, blk);
+    }
+    list_use_tlsf(freelist);
+    assert(freelist->length == 2 && freelist->tlsf->free_blocks == 2);
+
+    allocate_memory(freelist, alloclist, 1, 150, policy);  // only [200, 999] is large enough
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [0, 99] fits exactly
+    block_t *blk1 = list_get_node_by_pid(alloclist, 1)->blk;
+    assert(blk1->start == 200 && blk1->end == 349);
+    assert(list_get_node_by_pid(alloclist, 2)->blk->start == 0);
+    assert(freelist->length == 1);
+
+    allocate_memory(freelist, alloclist, 3, 700, policy);  // only 650 bytes left
+    assert(alloclist->length == 2);
+
+    // Freed blocks merge with free neighbours at once, but never across the gap
+    deallocate_memory(alloclist, freelist, 1, policy);
+    assert(freelist->length == 1);
+    deallocate_memory(alloclist, freelist, 2, policy);
+    assert(freelist->length == 2 && coalese_memory(freelist) == freelist);
+
+    int free_bytes, holes, largest;
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    assert(free_bytes == 900 && holes == 2 && largest == 800);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_tlsf_engine passed.\n");
+}
+
 int main() {
     run_all_tests();
     return 0;
 }
+
+void test_quick_lists() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO behind the quick lists
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+    list_use_quick(freelist, policy);
+
+    allocate_memory(freelist, alloclist, 1, 32, policy);   // [0, 31]
+    allocate_memory(freelist, alloclist, 2, 32, policy);   // [32, 63]
+    allocate_memory(freelist, alloclist, 3, 500, policy);  // [64, 563]
+
+    // A small freed block is cached, not added to the free list
+    deallocate_memory(alloclist, freelist, 1, policy);
+    assert(freelist->length == 1 && freelist->quick->cached == 1);
+
+    allocate_memory(freelist, alloclist, 4, 32, policy);   // served from the cache
+    assert(list_get_node_by_pid(alloclist, 4)->blk->start == 0);
+    assert(freelist->quick->hits == 1 && freelist->quick->cached == 0);
+
+    deallocate_memory(alloclist, freelist, 2, policy);
+    deallocate_memory(alloclist, freelist, 4, policy);
+    allocate_memory(freelist, alloclist, 5, 16, policy);   // 16 byte class is empty: free list
+    assert(list_get_node_by_pid(alloclist, 5)->blk->start == 564);
+    assert(freelist->quick->misses == 3 && freelist->quick->cached == 2);
+
+    int free_bytes, holes, largest;
+    free_list_summary(freelist, &free_bytes, &holes, &largest);
+    assert(free_bytes == 484 && holes == 3 && largest == 420);
+
+    // Coalescing flushes the cached blocks and merges them
+    freelist = coalese_memory(freelist);
+    assert(freelist->quick->cached == 0 && freelist->quick->flushes == 2);
+    assert(freelist->length == 2 && freelist->head->blk->end == 63);
+    list_free(freelist);
+    list_free(alloclist);
+
+    // Trace "100 / 1 100 / -1 0 / 2 50": the only free memory is cached, so
+    // the failed search flushes it and tries again
+    freelist = list_alloc();
+    alloclist = list_alloc();
+    partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 100 - 1;
+    list_add_to_back(freelist, partition);
+    list_use_quick(freelist, policy);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);
+    deallocate_memory(alloclist, freelist, 1, policy);
+    assert(freelist->length == 0 && freelist->quick->cached == 1);
+    allocate_memory(freelist, alloclist, 2, 50, policy);
+    assert(list_get_node_by_pid(alloclist, 2) != NULL);
+    assert(list_get_node_by_pid(alloclist, 2)->blk->start == 0);
+    assert(freelist->quick->cached == 0 && freelist->length == 1);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_quick_lists passed.\n");
+}
+
+void test_compact_memory() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 2; // Testing with Best Fit
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+    list_index_by_address(alloclist);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [100, 199]
+    allocate_memory(freelist, alloclist, 3, 100, policy);  // [200, 299]
+    allocate_memory(freelist, alloclist, 4, 700, policy);  // [300, 999]
+    deallocate_memory(alloclist, freelist, 1, policy);
+    deallocate_memory(alloclist, freelist, 3, policy);
+
+    allocate_memory(freelist, alloclist, 5, 200, policy);  // two 100 byte holes
+    assert(alloclist->length == 2);
+
+    // Cheapest plan: pid 2 slides up against pid 4, which stays put
+    assert(compact_memory(freelist, alloclist, policy) == 100);
+    assert(freelist->length == 1);
+    assert(freelist->head->blk->start == 0 && freelist->head->blk->end == 199);
+    assert(list_get_node_by_pid(alloclist, 2)->blk->start == 200);
+    assert(list_get_node_by_pid(alloclist, 4)->blk->start == 300);
+
+    allocate_memory(freelist, alloclist, 5, 200, policy);
+    assert(list_get_node_by_pid(alloclist, 5)->blk->start == 0);
+    assert(alloclist->head->blk->pid == 5);
+
+    // Nothing left to gather
+    assert(compact_memory(freelist, alloclist, policy) == 0);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_compact_memory passed.\n");
+}
+
+void test_allocate_memory_lazy() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO
+    lazy_coalesce_t lazy = {0};
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 300 - 1;
+    list_add_to_back(freelist, partition);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [100, 199]
+    allocate_memory(freelist, alloclist, 3, 100, policy);  // [200, 299]
+    deallocate_memory(alloclist, freelist, 1, policy);
+    deallocate_memory(alloclist, freelist, 2, policy);
+    lazy.dirty = true;
+
+    // Neither hole holds 150 bytes until they are merged
+    freelist = allocate_memory_lazy(freelist, alloclist, 4, 150, policy, &lazy);
+    assert(list_get_node_by_pid(alloclist, 4)->blk->start == 0);
+    assert(lazy.coalesces == 1 && lazy.rescued == 1 && !lazy.dirty);
+
+    // The length threshold merges [150, 199] and [200, 299] up front
+    deallocate_memory(alloclist, freelist, 3, policy);
+    lazy.dirty = true;
+    lazy.max_length = 2;
+    freelist = allocate_memory_lazy(freelist, alloclist, 5, 10, policy, &lazy);
+    assert(lazy.coalesces == 2 && lazy.rescued == 1);
+    assert(freelist->length == 1 && freelist->head->blk->start == 160);
+
+    // Nothing freed since: a failure is not worth a coalesce
+    freelist = allocate_memory_lazy(freelist, alloclist, 6, 200, policy, &lazy);
+    assert(alloclist->length == 2 && lazy.coalesces == 2);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_allocate_memory_lazy passed.\n");
+}
+
+void test_allocate_memory_batch() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+
+    // Strict: exactly what three allocate_memory calls would do
+    alloc_request_t strict[3] = {{1, 100, 0}, {2, 200, 0}, {3, 900, 0}};
+    assert(allocate_memory_batch(freelist, alloclist, strict, 3, policy, false) == 2);
+    assert(strict[0].start == 0 && strict[1].start == 100 && strict[2].start == -1);
+
+    deallocate_memory(alloclist, freelist, 1, policy);  // free list: [300, 999], [0, 99]
+
+    // In order, 60 bytes would split [300, 999] and leave no room for 650.
+    // Relaxed, the largest requests are placed first and everything fits.
+    alloc_request_t relaxed[4] = {{4, 60, 0}, {5, 650, 0}, {6, 50, 0}, {7, 40, 0}};
+    assert(allocate_memory_batch(freelist, alloclist, relaxed, 4, policy, true) == 4);
+    assert(relaxed[1].start == 300 && relaxed[2].start == 950);
+    assert(relaxed[0].start == 0 && relaxed[3].start == 60);
+    assert(freelist->length == 0 && alloclist->length == 5);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_allocate_memory_batch passed.\n");
+}
+
+void test_resize_memory() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [100, 199]
+    allocate_memory(freelist, alloclist, 3, 100, policy);  // [200, 299]
+
+    // Grows into the free block after it
+    assert(resize_memory(freelist, alloclist, 3, 150, policy) == RESIZE_IN_PLACE);
+    assert(list_get_node_by_pid(alloclist, 3)->blk->end == 349);
+    assert(freelist->head->blk->start == 350);
+
+    // Shrinks, freeing the tail, and grows back into it
+    assert(resize_memory(freelist, alloclist, 1, 50, policy) == RESIZE_IN_PLACE);
+    assert(freelist->length == 2 && freelist->tail->blk->start == 50);
+    assert(resize_memory(freelist, alloclist, 1, 100, policy) == RESIZE_IN_PLACE);
+    assert(freelist->length == 1 && list_get_node_by_pid(alloclist, 1)->blk->end == 99);
+
+    // Boxed in by pid 3: moved, and the old block freed
+    assert(resize_memory(freelist, alloclist, 2, 300, policy) == RESIZE_MOVED);
+    block_t *blk = list_get_node_by_pid(alloclist, 2)->blk;
+    assert(blk->start == 350 && blk->end == 649);
+    assert(alloclist->length == 3 && freelist->length == 2);
+    assert(freelist->tail->blk->start == 100 && freelist->tail->blk->end == 199);
+
+    // No room anywhere, or no block: nothing changes
+    assert(resize_memory(freelist, alloclist, 2, 5000, policy) == RESIZE_FAILED);
+    assert(blk->start == 350 && blk->end == 649);
+    assert(resize_memory(freelist, alloclist, 9, 10, policy) == RESIZE_FAILED);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_resize_memory passed.\n");
+}
+
+void test_deallocate_memory_pid_chain() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO
+
+    list_index_by_pid(alloclist);
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [100, 199]
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [200, 299]
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [300, 399]
+
+    // PID 1's blocks are found by address, the lowest first
+    assert(list_get_node_by_pid(alloclist, 1)->blk->start == 0);
+    for (int start = 0; start < 400; start += 100)
+        assert((list_get_node_by_pid_at(alloclist, 1, start) != NULL) == (start != 100));
+
+    // One block by address: the middle one leaves the index
+    assert(!deallocate_block(alloclist, freelist, 1, 100, policy));
+    assert(deallocate_block(alloclist, freelist, 1, 200, policy));
+    assert(list_get_node_by_pid_at(alloclist, 1, 200) == NULL);
+    assert(list_get_node_by_pid_at(alloclist, 1, 300)->blk->start == 300);
+    assert(alloclist->length == 3);
+
+    // The next block moves up when the first goes, and a lower one replaces it
+    assert(deallocate_block(alloclist, freelist, 1, 0, policy));
+    assert(list_get_node_by_pid(alloclist, 1)->blk->start == 300);
+    allocate_memory(freelist, alloclist, 3, 600, policy);  // [400, 999]
+    allocate_memory(freelist, alloclist, 3, 100, policy);  // [200, 299]
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    assert(list_get_node_by_pid(alloclist, 1)->blk->start == 0);
+    assert(list_get_node_by_pid_at(alloclist, 1, 300) != NULL);
+
+    // The rest of PID 1 at once; PIDs 2 and 3 are untouched
+    assert(deallocate_all_memory(alloclist, freelist, 1, policy) == 2);
+    assert(list_get_node_by_pid(alloclist, 1) == NULL);
+    assert(alloclist->length == 3 && alloclist->head->blk->pid == 2);
+    assert(deallocate_all_memory(alloclist, freelist, 1, policy) == 0);
+
+    list_free(freelist);
+    list_free(alloclist);
+
+    // Blocks above the others are appended and the lowest dropped from the
+    // front, so a sliding window of blocks keeps the array small
+    pid_map_t *map = pid_map_alloc();
+    pid_slot_t *slot = NULL;
+    block_t blocks[200];
+
+    for (int i = 0; i < 200; i++) {
+        blocks[i].pid = 5; blocks[i].start = i * 10; blocks[i].end = i * 10 + 9;
+        blocks[i].link.blk = &blocks[i];
+    }
+    for (int i = 0; i < 64; i++)
+        pid_map_add(map, &blocks[i].link);
+    for (int i = 0; i < map->capacity; i++)
+        slot = map->slots[i].pid == 5 ? &map->slots[i] : slot;
+    assert(slot->count == 64 && slot->first == 0 && slot->rest[62] == &blocks[63].link);
+    for (int i = 64; i < 200; i++) {
+        pid_map_remove(map, &blocks[i - 64].link);
+        pid_map_add(map, &blocks[i].link);
+        assert(pid_map_get(map, 5) == &blocks[i - 63].link);
+    }
+    assert(slot->count == 64 && slot->capacity <= 128);
+    assert(pid_map_get_at(map, 5, 1500) == &blocks[150].link && pid_map_get_at(map, 5, 1505) == NULL);
+    pid_map_add(map, &blocks[0].link);   // a new lowest block goes in front
+    assert(pid_map_get(map, 5) == &blocks[0].link && pid_map_get_at(map, 5, 1360) != NULL);
+    pid_map_remove(map, &blocks[0].link);
+    for (int i = 136; i < 200; i++)
+        pid_map_remove(map, &blocks[i].link);
+    assert(pid_map_get(map, 5) == NULL && map->used == 0);
+    pid_map_free(map);
+
+    printf("test_deallocate_memory_pid_chain passed.\n");
+}
+
+void test_query_address() {
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    int policy = 1; // Testing with FIFO
+    addr_owner_t owner;
+
+    block_t *partition = block_alloc();
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+
+    allocate_memory(freelist, alloclist, 1, 100, policy);  // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, policy);  // [100, 199]
+    allocate_memory(freelist, alloclist, 3, 100, policy);  // [200, 299]
+    deallocate_memory(alloclist, freelist, 2, policy);
+
+    for (int indexed = 0; indexed < 2; indexed++) {
+        if (indexed)
+            list_index_by_address(alloclist);
+
+        assert(query_address(alloclist, 1000, 250, &owner));
+        assert(owner.pid == 3 && owner.start == 200 && owner.end == 299);
+        assert(query_address(alloclist, 1000, 99, &owner) && owner.pid == 1);
+
+        // Free addresses report the whole range between allocated blocks
+        assert(query_address(alloclist, 1000, 150, &owner));
+        assert(owner.pid == 0 && owner.start == 100 && owner.end == 199);
+        assert(query_address(alloclist, 1000, 999, &owner));
+        assert(owner.pid == 0 && owner.start == 300 && owner.end == 999);
+        assert(!query_address(alloclist, 1000, 1000, &owner));
+
+        assert(query_range(alloclist, 120, 210, &owner) && owner.pid == 3);
+        assert(!query_range(alloclist, 100, 199, &owner));
+        assert(!query_range(alloclist, 300, 999, &owner));
+    }
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_query_address passed.\n");
+}
+
+void test_paging_engine() {
+    mem_stats_t before = {0, 0}, after = {0, 0};
+
+    paging_mem_stats(&before);
+    paging_t *pg = paging_alloc(1000, 100, 2);  // 10 frames
+    assert(pg->frames.frames == 10 && pg->frames.free == 10);
+
+    // Whole pages are mapped at the PID's next virtual address
+    assert(paging_map(pg, 1, 250) == 0);
+    assert(paging_map(pg, 2, 100) == 0);
+    assert(paging_map(pg, 1, 10) == 300);
+    assert(pg->frames.free == 5 && pg->mapped_pages == 5);
+    assert(pg->tables[0] == 2 && pg->tables[1] == 2);
+
+    // Frames are taken lowest first, wherever they are
+    assert(paging_translate(pg, 1, 0) == 0 && paging_translate(pg, 1, 299) == 2);
+    assert(paging_translate(pg, 2, 50) == 3 && paging_translate(pg, 1, 300) == 4);
+    assert(paging_translate(pg, 1, 400) == -1 && paging_translate(pg, 3, 0) == -1);
+
+    // Not enough frames: nothing is mapped
+    assert(paging_map(pg, 3, 600) == -1);
+    assert(pg->frames.free == 5 && pg->proc_used == 2);
+
+    // A free unmaps the lowest region; the freed frames are reused
+    assert(paging_unmap(pg, 1));
+    assert(paging_translate(pg, 1, 0) == -1 && paging_translate(pg, 1, 300) == 4);
+    assert(paging_map(pg, 3, 800) == 0 && pg->frames.free == 0);
+    assert(paging_translate(pg, 3, 0) == 0);
+
+    // Releasing everything gives the page tables back
+    assert(paging_unmap_all(pg, 3) == 1);
+    assert(paging_unmap_all(pg, 1) == 1 && !paging_unmap(pg, 1));
+    assert(paging_unmap(pg, 2));
+    assert(pg->proc_used == 0 && pg->tables[0] == 0 && pg->tables[1] == 0);
+    assert(pg->peak_tables[1] == 3 && pg->frames.free == 10);
+
+    paging_free(pg);
+    paging_mem_stats(&after);
+    assert(after.in_use == before.in_use);
+    printf("test_paging_engine passed.\n");
+}
+
+void test_tlb() {
+    int base, size;
+
+    // Unsupported geometries
+    assert(tlb_alloc(12, 4, TLB_LRU, false) == NULL);    // 3 sets
+    assert(tlb_alloc(6, 6, TLB_PLRU, false) == NULL);    // ways not a power of two
+
+    // One set of two ways: LRU keeps the page used last
+    tlb_t *tlb = tlb_alloc(2, 2, TLB_LRU, true);
+    assert(!tlb_lookup(tlb, 1, 10, &base, &size));
+    tlb_insert(tlb, 1, 10, 640, 64);
+    tlb_insert(tlb, 1, 11, 704, 64);
+    assert(tlb_lookup(tlb, 1, 10, &base, &size) && base == 640);
+    tlb_insert(tlb, 1, 12, 768, 64);                         // evicts 11
+    assert(!tlb_lookup(tlb, 1, 11, &base, &size) && tlb_lookup(tlb, 1, 10, &base, &size));
+
+    // PID tags keep other address spaces apart without flushing
+    assert(!tlb_lookup(tlb, 2, 10, &base, &size));
+    assert(tlb_lookup(tlb, 1, 10, &base, &size));
+    tlb_invalidate_pid(tlb, 1);
+    assert(!tlb_lookup(tlb, 1, 10, &base, &size) && tlb->invalidations == 2);
+    assert(tlb->current->hits == 3 && tlb->current->misses == 3 && tlb->current->flushes == 0);
+    tlb_free(tlb);
+
+    // Pseudo-LRU over four ways
+    tlb = tlb_alloc(4, 4, TLB_PLRU, false);
+    for (int vpn = 0; vpn < 4; vpn++)
+        tlb_insert(tlb, 1, vpn, vpn * 64, 64);
+    assert(tlb_lookup(tlb, 1, 0, &base, &size));
+    tlb_insert(tlb, 1, 4, 256, 64);                          // the tree points at way 2
+    assert(!tlb_lookup(tlb, 1, 2, &base, &size));
+    assert(tlb_lookup(tlb, 1, 0, &base, &size) && tlb_lookup(tlb, 1, 3, &base, &size));
+
+    // Without tags a switch to another PID flushes everything
+    assert(!tlb_lookup(tlb, 2, 0, &base, &size));
+    assert(tlb->current->flushes == 1);
+    tlb_insert(tlb, 2, 0, 512, 64);
+    assert(!tlb_lookup(tlb, 1, 0, &base, &size));
+    tlb_free(tlb);
+
+    // Translation through the TLB under contiguous allocation
+    list_t *freelist = list_alloc();
+    list_t *alloclist = list_alloc();
+    block_t *partition = block_alloc();
+    bool hit;
+    partition->pid = 0;
+    partition->start = 0;
+    partition->end = 1000 - 1;
+    list_add_to_back(freelist, partition);
+    allocate_memory(freelist, alloclist, 1, 100, 1);    // [0, 99]
+    allocate_memory(freelist, alloclist, 2, 100, 1);    // [100, 199]
+
+    tlb = tlb_alloc(4, 4, TLB_LRU, true);
+    assert(translate_address(alloclist, NULL, tlb, 64, 2, 70, &hit) == 170 && !hit);
+    assert(translate_address(alloclist, NULL, tlb, 64, 2, 80, &hit) == 180 && hit);
+    assert(translate_address(alloclist, NULL, tlb, 64, 2, 200, &hit) == -1 && !hit);
+    assert(translate_address(alloclist, NULL, tlb, 64, 3, 0, &hit) == -1);
+
+    // Trace "1000 / 1 100 / -99995 1 70 / -99995 1 120": PID 1's block ends
+    // part way into page 1, so 120 is invalid with the page cached or not
+    assert(translate_address(alloclist, NULL, NULL, 64, 1, 120, &hit) == -1);
+    assert(translate_address(alloclist, NULL, tlb, 64, 1, 70, &hit) == 70 && !hit);
+    assert(translate_address(alloclist, NULL, tlb, 64, 1, 120, &hit) == -1 && hit);
+    assert(translate_address(alloclist, NULL, tlb, 64, 1, 99, &hit) == 99 && hit);
+    tlb_free(tlb);
+
+    list_free(freelist);
+    list_free(alloclist);
+    printf("test_tlb passed.\n");
+}
+
+void test_page_replacement() {
+    uint64_t victim;
+    mem_stats_t before = {0, 0}, after = {0, 0};
+
+    replace_mem_stats(&before);
+
+    // LRU: the page used longest ago goes
+    replacer_t *r = replace_alloc(REPLACE_LRU, 2);
+    assert(!replace_admit(r, 1, &victim) && !replace_admit(r, 2, &victim));
+    replace_touch(r, 1);
+    assert(replace_admit(r, 3, &victim) && victim == 2);
+    replace_remove(r, 1);                                // an unmapped page frees a slot
+    assert(!replace_admit(r, 4, &victim));
+    replace_free(r);
+
+    // CLOCK: the hand clears reference bits and takes the first page without one
+    r = replace_alloc(REPLACE_CLOCK, 2);
+    replace_admit(r, 1, &victim);
+    replace_admit(r, 2, &victim);
+    assert(replace_admit(r, 3, &victim) && victim == 1);
+    assert(replace_admit(r, 4, &victim) && victim == 2); // 3 is spared, its bit was set
+    replace_free(r);
+
+    // ARC: a page asked for again from B1 grows T1's target
+    r = replace_alloc(REPLACE_ARC, 2);
+    replace_admit(r, 1, &victim);
+    replace_admit(r, 2, &victim);
+    replace_touch(r, 1);                                 // 1 moves to T2
+    assert(replace_admit(r, 3, &victim) && victim == 2);
+    assert(r->size[REPLACE_B1] == 1);
+    assert(replace_admit(r, 2, &victim) && victim == 1); // ghost hit: T1 keeps 3
+    assert(r->target == 1 && r->size[REPLACE_B2] == 1);
+    replace_free(r);
+
+    // An overcommitted pager evicts pages and faults them back in on access
+    paging_t *pg = paging_alloc(256, 64, 2);             // 4 frames
+    paging_use_replacement(pg, REPLACE_LRU);
+    assert(paging_map(pg, 1, 192) == 0);
+    assert(paging_map(pg, 2, 128) == 0);                 // evicts page 0 of PID 1
+    assert(pg->evictions == 1 && pg->swapped == 1);
+    assert(paging_translate(pg, 1, 0) == -1);
+    assert(paging_access(pg, 1, 10) >= 0 && pg->faults == 1);
+    assert(paging_translate(pg, 1, 64) == -1);           // the next least recently used
+    assert(paging_access(pg, 2, 0) >= 0 && pg->faults == 1 && pg->accesses == 2);
+    paging_touch(pg, 1, 2);                              // a TLB hit counts as a use
+    assert(pg->accesses == 3 && pg->faults == 1);
+    assert(paging_access(pg, 1, 64) >= 0 && pg->faults == 2);
+    assert(paging_translate(pg, 2, 64) == -1 && paging_translate(pg, 1, 128) >= 0);
+    assert(paging_unmap(pg, 1));
+    assert(pg->swapped == 1 && pg->frames.free == 3 && pg->peak_swapped == 1);
+    paging_free(pg);
+
+    replace_mem_stats(&after);
+    assert(after.in_use == before.in_use);
+    printf("test_page_replacement passed.\n");
+}
@@ -0,0 +1,302 @@
+// tlb.c
+//
+// Implementation for the TLB model.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "./Headers/tlb.h"
+
+#define TLB_INITIAL_STATS 64
+
+static mem_stats_t tlb_bytes;
+
+/***** Helpers ********/
+
+static void *checked_calloc(size_t count, size_t size) {
+    void *p = calloc(count, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: tlb_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static bool is_power_of_two(int x) {
+    return x > 0 && (x & (x - 1)) == 0;
+}
+
+static unsigned int hash_pid(int pid) {
+    return (unsigned int)pid * 2654435761u; // Knuth multiplicative hash
+}
+
+/* Returns the slot holding pid, or the empty slot where it would go. */
+static tlb_pid_stats_t *find_stats(tlb_t *tlb, int pid) {
+    unsigned int mask = tlb->stats_capacity - 1;
+    unsigned int i = hash_pid(pid) & mask;
+
+    while (tlb->stats[i].pid != 0 && tlb->stats[i].pid != pid)
+        i = (i + 1) & mask;
+    return &tlb->stats[i];
+}
+
+/* Returns the stats of pid, adding them if needed. PIDs are never removed. */
+static tlb_pid_stats_t *stats_for(tlb_t *tlb, int pid) {
+    tlb_pid_stats_t *slot = find_stats(tlb, pid);
+
+    if (slot->pid != 0)
+        return slot;
+
+    if (2 * (tlb->stats_used + 1) > tlb->stats_capacity) {  // double once half full
+        tlb_pid_stats_t *old = tlb->stats;
+        int old_capacity = tlb->stats_capacity;
+
+        tlb->stats_capacity *= 2;
+        tlb->stats = checked_calloc(tlb->stats_capacity, sizeof(tlb_pid_stats_t));
+        mem_stats_track(&tlb_bytes, (long)old_capacity * sizeof(tlb_pid_stats_t));
+        for (int i = 0; i < old_capacity; i++) {
+            if (old[i].pid != 0)
+                *find_stats(tlb, old[i].pid) = old[i];
+        }
+        free(old);
+        slot = find_stats(tlb, pid);
+    }
+    slot->pid = pid;
+    tlb->stats_used++;
+    return slot;
+}
+
+/* Points the tree bits of a set away from way, so it is the last to go. A
+ * set bit at node n means the victim is in n's upper half. */
+static void plru_touch(unsigned int *bits, int ways, int way) {
+    int node = 1;
+
+    for (int half = ways / 2; half > 0; half /= 2) {
+        int upper = (way & half) != 0;
+        if (upper)
+            *bits &= ~(1u << node);
+        else
+            *bits |= 1u << node;
+        node = 2 * node + upper;
+    }
+}
+
+static int plru_victim(unsigned int bits, int ways) {
+    int node = 1, way = 0;
+
+    for (int half = ways / 2; half > 0; half /= 2) {
+        int upper = (bits >> node) & 1;
+        way += upper ? half : 0;
+        node = 2 * node + upper;
+    }
+    return way;
+}
+
+static uint64_t rng_next(uint64_t *state) {  // xorshift64
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static int compare_stats_pid(const void *a, const void *b) {
+    int x = ((const tlb_pid_stats_t *)a)->pid;
+    int y = ((const tlb_pid_stats_t *)b)->pid;
+    return (x > y) - (x < y);
+}
+
+/***** Function Definitions ********/
+
+tlb_t *tlb_alloc(int entries, int ways, tlb_policy_t policy, bool tagged) {
+    if (ways < 1 || entries < ways || entries % ways != 0 || !is_power_of_two(entries / ways))
+        return NULL;
+    if (policy == TLB_PLRU && (!is_power_of_two(ways) || ways > TLB_PLRU_MAX_WAYS))
+        return NULL;
+
+    tlb_t *tlb = checked_calloc(1, sizeof(tlb_t));
+    tlb->sets = entries / ways;
+    tlb->ways = ways;
+    tlb->policy = policy;
+    tlb->tagged = tagged;
+    tlb->entries = checked_calloc(entries, sizeof(tlb_entry_t));
+    tlb->plru = checked_calloc(tlb->sets, sizeof(unsigned int));
+    tlb->clock = 1;
+    tlb->rng = 0x9E3779B97F4A7C15ull;
+    tlb->stats_capacity = TLB_INITIAL_STATS;
+    tlb->stats = checked_calloc(tlb->stats_capacity, sizeof(tlb_pid_stats_t));
+    mem_stats_track(&tlb_bytes, sizeof(tlb_t) + entries * sizeof(tlb_entry_t) +
+                                tlb->sets * sizeof(unsigned int) +
+                                tlb->stats_capacity * sizeof(tlb_pid_stats_t));
+    return tlb;
+}
+
+void tlb_free(tlb_t *tlb) {
+    if (tlb != NULL) {
+        mem_stats_track(&tlb_bytes, -(long)(sizeof(tlb_t) + tlb->sets * tlb->ways * sizeof(tlb_entry_t) +
+                                            tlb->sets * sizeof(unsigned int) +
+                                            tlb->stats_capacity * sizeof(tlb_pid_stats_t)));
+        free(tlb->entries);
+        free(tlb->plru);
+        free(tlb->stats);
+        free(tlb);
+    }
+}
+
+void tlb_mem_stats(mem_stats_t *stats) {
+    stats->in_use += tlb_bytes.in_use;
+    stats->peak += tlb_bytes.peak;
+}
+
+/**
+ * Function: tlb_lookup
+ * --------------------
+ * Looks up a page in its set.
+ *
+ * Description:
+ *  Only the ways of one set are compared, and the per PID counters are
+ *  looked up again only when the PID changes, so a lookup costs a few
+ *  compares. A PID change without PID tags flushes every entry, charged to
+ *  the PID switched to.
+ */
+bool tlb_lookup(tlb_t *tlb, int pid, long vpn, int *base, int *size) {
+    if (pid != tlb->current_pid) {
+        tlb->current = stats_for(tlb, pid);
+        if (!tlb->tagged && tlb->current_pid != 0) {
+            for (int i = 0; i < tlb->sets * tlb->ways; i++)
+                tlb->entries[i].valid = false;
+            tlb->current->flushes++;
+        }
+        tlb->current_pid = pid;
+    }
+
+    int set = vpn & (tlb->sets - 1);
+    tlb_entry_t *way = &tlb->entries[set * tlb->ways];
+    for (int w = 0; w < tlb->ways; w++, way++) {
+        if (way->valid && way->vpn == vpn && way->pid == pid) {
+            if (tlb->policy == TLB_LRU)
+                way->stamp = tlb->clock++;
+            else if (tlb->policy == TLB_PLRU)
+                plru_touch(&tlb->plru[set], tlb->ways, w);
+            *base = way->base;
+            *size = way->size;
+            tlb->current->hits++;
+            return true;
+        }
+    }
+    tlb->current->misses++;
+    return false;
+}
+
+/**
+ * Function: tlb_insert
+ * --------------------
+ * Caches a translation in the set of its page.
+ *
+ * Description:
+ *  An invalid way is used if the set has one; otherwise the policy picks the
+ *  victim: the oldest stamp for LRU, the way the tree bits lead to for
+ *  pseudo-LRU, or any way for random.
+ */
+void tlb_insert(tlb_t *tlb, int pid, long vpn, int base, int size) {
+    int set = vpn & (tlb->sets - 1);
+    tlb_entry_t *ways = &tlb->entries[set * tlb->ways];
+    int victim = -1;
+
+    for (int w = 0; w < tlb->ways && victim < 0; w++) {
+        if (!ways[w].valid)
+            victim = w;
+    }
+    if (victim < 0) {
+        if (tlb->policy == TLB_LRU) {
+            victim = 0;
+            for (int w = 1; w < tlb->ways; w++) {
+                if (ways[w].stamp < ways[victim].stamp)
+                    victim = w;
+            }
+        }
+        else if (tlb->policy == TLB_PLRU) {
+            victim = plru_victim(tlb->plru[set], tlb->ways);
+        }
+        else {
+            victim = rng_next(&tlb->rng) % tlb->ways;
+        }
+    }
+
+    ways[victim].vpn = vpn;
+    ways[victim].pid = pid;
+    ways[victim].base = base;
+    ways[victim].size = size;
+    ways[victim].stamp = tlb->clock++;
+    ways[victim].valid = true;
+    if (tlb->policy == TLB_PLRU)
+        plru_touch(&tlb->plru[set], tlb->ways, victim);
+}
+
+void tlb_invalidate_pid(tlb_t *tlb, int pid) {
+    for (int i = 0; i < tlb->sets * tlb->ways; i++) {
+        if (tlb->entries[i].valid && tlb->entries[i].pid == pid) {
+            tlb->entries[i].valid = false;
+            tlb->invalidations++;
+        }
+    }
+}
+
+void tlb_invalidate_page(tlb_t *tlb, int pid, long vpn) {
+    tlb_entry_t *way = &tlb->entries[(vpn & (tlb->sets - 1)) * tlb->ways];
+
+    for (int w = 0; w < tlb->ways; w++, way++) {
+        if (way->valid && way->vpn == vpn && way->pid == pid) {
+            way->valid = false;
+            tlb->invalidations++;
+        }
+    }
+}
+
+void tlb_invalidate_all(tlb_t *tlb) {
+    for (int i = 0; i < tlb->sets * tlb->ways; i++) {
+        if (tlb->entries[i].valid) {
+            tlb->entries[i].valid = false;
+            tlb->invalidations++;
+        }
+    }
+}
+
+/**
+ * Function: tlb_print_stats
+ * -------------------------
+ * Prints one line per PID in ascending PID order, then the totals.
+ */
+void tlb_print_stats(tlb_t *tlb) {
+    tlb_pid_stats_t *sorted = malloc((tlb->stats_used > 0 ? tlb->stats_used : 1) * sizeof(tlb_pid_stats_t));
+    tlb_pid_stats_t total = {0, 0, 0, 0};
+    int n = 0;
+
+    if (sorted == NULL) {
+        fprintf(stderr, "Error: tlb_print_stats failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < tlb->stats_capacity; i++) {
+        if (tlb->stats[i].pid != 0)
+            sorted[n++] = tlb->stats[i];
+    }
+    qsort(sorted, n, sizeof(tlb_pid_stats_t), compare_stats_pid);
+
+    printf("TLB: %d entries, %d ways, %s%s\n", tlb->sets * tlb->ways, tlb->ways,
+           tlb->policy == TLB_LRU ? "LRU" : tlb->policy == TLB_PLRU ? "PLRU" : "RANDOM",
+           tlb->tagged ? ", PID tags" : "");
+    for (int i = 0; i < n; i++) {
+        long lookups = sorted[i].hits + sorted[i].misses;
+        printf("PID %d:\t HITS: %ld\t MISSES: %ld\t FLUSHES: %ld\t HIT RATE: %.2f%%\n", sorted[i].pid,
+               sorted[i].hits, sorted[i].misses, sorted[i].flushes,
+               lookups > 0 ? 100.0 * sorted[i].hits / lookups : 0.0);
+        total.hits += sorted[i].hits;
+        total.misses += sorted[i].misses;
+        total.flushes += sorted[i].flushes;
+    }
+    long lookups = total.hits + total.misses;
+    printf("Total:\t HITS: %ld\t MISSES: %ld\t FLUSHES: %ld\t HIT RATE: %.2f%%\t INVALIDATED: %ld\n",
+           total.hits, total.misses, total.flushes, lookups > 0 ? 100.0 * total.hits / lookups : 0.0,
+           tlb->invalidations);
+    free(sorted);
+}
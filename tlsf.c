@@ -0,0 +1,290 @@
+// tlsf.c
+//
+// Implementation for the two-level segregated fit (TLSF) engine.
+
+/***** Necessary Headers FIles ********/
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/tlsf.h"
+
+#define TLSF_INITIAL_CAPACITY 64
+
+static tlsf_t *live_engines = NULL;
+static mem_stats_t engine_bytes;
+
+/***** Helpers ********/
+
+static int floor_log2(unsigned int x) {
+    return 31 - __builtin_clz(x);
+}
+
+/* Returns the list a free block of this size belongs to. */
+static void mapping_insert(int size, int *fl, int *sl) {
+    *fl = floor_log2(size);
+    if (*fl >= TLSF_SL_LOG2)
+        *sl = (size >> (*fl - TLSF_SL_LOG2)) - TLSF_SL_COUNT;
+    else
+        *sl = (size << (TLSF_SL_LOG2 - *fl)) - TLSF_SL_COUNT;
+}
+
+/* Returns the first list whose blocks are all at least size bytes: the size
+ * is rounded up to the next second level boundary before mapping. Below
+ * TLSF_SL_COUNT every list holds a single size, so nothing is rounded. */
+static void mapping_search(int size, int *fl, int *sl) {
+    int f = floor_log2(size);
+    if (f >= TLSF_SL_LOG2) {
+        long rounded = size + (1L << (f - TLSF_SL_LOG2)) - 1;
+        size = rounded > 0x7fffffff ? 0x7fffffff : (int)rounded;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static int new_header(tlsf_t *t) {
+    int h;
+
+    if (t->unused >= 0) {
+        h = t->unused;
+        t->unused = t->hdr[h].free_next;
+        return h;
+    }
+    if (t->count == t->capacity) {
+        tlsf_header_t *grown = realloc(t->hdr, 2 * t->capacity * sizeof(tlsf_header_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: tlsf_take failed\n");
+            exit(EXIT_FAILURE);
+        }
+        mem_stats_track(&engine_bytes, (long)t->capacity * sizeof(tlsf_header_t));
+        t->hdr = grown;
+        t->capacity *= 2;
+    }
+    return t->count++;
+}
+
+static void recycle_header(tlsf_t *t, int h) {
+    t->hdr[h].free_next = t->unused;
+    t->unused = h;
+}
+
+static void insert_free(tlsf_t *t, int h) {
+    int fl, sl;
+    tlsf_header_t *b = &t->hdr[h];
+
+    mapping_insert(b->size, &fl, &sl);
+    b->free = true;
+    b->free_prev = -1;
+    b->free_next = t->heads[fl][sl];
+    if (b->free_next >= 0)
+        t->hdr[b->free_next].free_prev = h;
+    t->heads[fl][sl] = h;
+
+    t->fl_bitmap |= 1u << fl;
+    t->sl_bitmap[fl] |= 1u << sl;
+    t->free_blocks++;
+}
+
+static void remove_free(tlsf_t *t, int h) {
+    int fl, sl;
+    tlsf_header_t *b = &t->hdr[h];
+
+    mapping_insert(b->size, &fl, &sl);
+    if (b->free_prev >= 0)
+        t->hdr[b->free_prev].free_next = b->free_next;
+    else
+        t->heads[fl][sl] = b->free_next;
+    if (b->free_next >= 0)
+        t->hdr[b->free_next].free_prev = b->free_prev;
+
+    if (t->heads[fl][sl] < 0) {
+        t->sl_bitmap[fl] &= ~(1u << sl);
+        if (t->sl_bitmap[fl] == 0)
+            t->fl_bitmap &= ~(1u << fl);
+    }
+    b->free = false;
+    t->free_blocks--;
+}
+
+/* Merges the physical successor of h into h. Neither may be on a list. */
+static void merge_next(tlsf_t *t, int h) {
+    int n = t->hdr[h].phys_next;
+
+    t->hdr[h].size += t->hdr[n].size;
+    t->hdr[h].phys_next = t->hdr[n].phys_next;
+    if (t->hdr[n].phys_next >= 0)
+        t->hdr[t->hdr[n].phys_next].phys_prev = h;
+    else
+        t->last = h;
+    recycle_header(t, n);
+}
+
+/* Appends a used block [start, end] after the highest block. */
+static int append_header(tlsf_t *t, int start, int end) {
+    int h = new_header(t);
+    tlsf_header_t *b = &t->hdr[h];
+
+    b->start = start;
+    b->size = end - start + 1;
+    b->phys_prev = t->last;
+    b->phys_next = -1;
+    b->free = false;
+    if (t->last >= 0)
+        t->hdr[t->last].phys_next = h;
+    else
+        t->first = h;
+    t->last = h;
+    return h;
+}
+
+/***** Function Definitions ********/
+
+/**
+ * Function: tlsf_alloc
+ * --------------------
+ * Allocates an engine without any memory. Exits with a failure status if
+ * malloc fails.
+ */
+tlsf_t *tlsf_alloc() {
+    tlsf_t *t = malloc(sizeof(tlsf_t));
+    if (t != NULL)
+        t->hdr = malloc(TLSF_INITIAL_CAPACITY * sizeof(tlsf_header_t));
+    if (t == NULL || t->hdr == NULL) {
+        fprintf(stderr, "Error: tlsf_alloc failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t->count = 0;
+    t->capacity = TLSF_INITIAL_CAPACITY;
+    t->unused = t->first = t->last = -1;
+    t->free_blocks = 0;
+    t->fl_bitmap = 0;
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        t->sl_bitmap[fl] = 0;
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++)
+            t->heads[fl][sl] = -1;
+    }
+    mem_stats_track(&engine_bytes, sizeof(tlsf_t) + t->capacity * sizeof(tlsf_header_t));
+
+    t->prev = NULL;
+    t->next = live_engines;
+    if (live_engines != NULL)
+        live_engines->prev = t;
+    live_engines = t;
+    return t;
+}
+
+void tlsf_free(tlsf_t *t) {
+    if (t != NULL) {
+        if (t->prev != NULL)
+            t->prev->next = t->next;
+        else
+            live_engines = t->next;
+        if (t->next != NULL)
+            t->next->prev = t->prev;
+
+        mem_stats_track(&engine_bytes, -(long)(sizeof(tlsf_t) + t->capacity * sizeof(tlsf_header_t)));
+        free(t->hdr);
+        free(t);
+    }
+}
+
+void tlsf_release_all() {
+    while (live_engines != NULL)
+        tlsf_free(live_engines);
+}
+
+void tlsf_mem_stats(mem_stats_t *stats) {
+    stats->in_use += engine_bytes.in_use;
+    stats->peak += engine_bytes.peak;
+}
+
+void tlsf_add_range(tlsf_t *t, int start, int end) {
+    int last = t->last;
+
+    if (last >= 0) {
+        int gap_start = t->hdr[last].start + t->hdr[last].size;
+        if (gap_start < start) {
+            append_header(t, gap_start, start - 1);  // never freed, keeps the ranges apart
+        }
+        else if (t->hdr[last].free) {
+            remove_free(t, last);                    // adjacent to a free range: extend it
+            t->hdr[last].size += end - start + 1;
+            insert_free(t, last);
+            return;
+        }
+    }
+    insert_free(t, append_header(t, start, end));
+}
+
+/**
+ * Function: tlsf_take
+ * -------------------
+ * Allocates size bytes in constant time.
+ *
+ * Description:
+ *  mapping_search picks the first list that only holds blocks large enough;
+ *  the second level bitmap of its first level, then the first level bitmap,
+ *  give the nearest non-empty list at or above it. The head block of that
+ *  list is used and whatever is left of it goes back as a free block.
+ */
+int tlsf_take(tlsf_t *t, int size) {
+    int fl, sl;
+    unsigned int map;
+
+    if (size < 1)
+        size = 1;
+    mapping_search(size, &fl, &sl);
+    if (fl >= TLSF_FL_COUNT)
+        return -1;
+
+    map = t->sl_bitmap[fl] & (~0u << sl);
+    if (map == 0) {
+        map = fl + 1 < TLSF_FL_COUNT ? t->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (map == 0)
+            return -1;
+        fl = __builtin_ctz(map);
+        map = t->sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(map);
+
+    int h = t->heads[fl][sl];
+    remove_free(t, h);
+
+    if (t->hdr[h].size > size) {
+        int rest = new_header(t);      // may move t->hdr
+        tlsf_header_t *b = &t->hdr[h], *r = &t->hdr[rest];
+
+        r->start = b->start + size;
+        r->size = b->size - size;
+        r->phys_prev = h;
+        r->phys_next = b->phys_next;
+        if (b->phys_next >= 0)
+            t->hdr[b->phys_next].phys_prev = rest;
+        else
+            t->last = rest;
+        b->phys_next = rest;
+        b->size = size;
+        insert_free(t, rest);
+    }
+    return h;
+}
+
+/**
+ * Function: tlsf_release
+ * ----------------------
+ * Frees a block in constant time, merging it with a free successor and a
+ * free predecessor before it goes back on its segregated list.
+ */
+void tlsf_release(tlsf_t *t, int h) {
+    int n = t->hdr[h].phys_next;
+    int p = t->hdr[h].phys_prev;
+
+    if (n >= 0 && t->hdr[n].free) {
+        remove_free(t, n);
+        merge_next(t, h);
+    }
+    if (p >= 0 && t->hdr[p].free) {
+        remove_free(t, p);
+        merge_next(t, p);
+        h = p;
+    }
+    insert_free(t, h);
+}
@@ -0,0 +1,26 @@
+// trace2bin.c
+//
+// Converts a text trace into the binary trace format read by mmu.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "./Headers/util.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        printf("usage: ./trace2bin <input file> <output file>\n");
+        exit(1);
+    }
+
+    long count = trace_convert(argv[1], argv[2]);
+    if (count == -1) {
+        fprintf(stderr, "Error: Invalid filepath\n");
+        exit(1);
+    }
+    if (count < 0)
+        exit(1);  // trace_convert has said why
+
+    printf("Wrote %ld operations to %s\n", count, argv[2]);
+    return 0;
+}
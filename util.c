@@ -3,36 +3,284 @@
 #include<unistd.h>
 #include<stdlib.h>
 #include<errno.h>
+#include<fcntl.h>
+#include<string.h>
+#include<limits.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
 
 #include "./Headers/util.h"
 #include "./Headers/list.h"
 
-void parse_file(FILE *f, int input[][2], int *n, int *PARTITION_SIZE) {
-    if (f == NULL) {
-        fprintf(stderr, "Error: File pointer is NULL\n");
-        return;
+/* Reads the next block of the file into the buffer. Returns false at EOF. */
+static bool refill(trace_reader_t *trace) {
+    ssize_t n;
+
+    if (trace->eof)
+        return false;
+
+    do {
+        n = read(trace->fd, trace->buf, TRACE_BUFFER_SIZE);
+    } while (n < 0 && errno == EINTR);
+
+    if (n <= 0) {
+        if (n < 0)
+            fprintf(stderr, "Error reading file\n");
+        trace->eof = true;
+        trace->len = trace->pos = 0;
+        return false;
+    }
+
+    trace->len = (size_t)n;
+    trace->pos = 0;
+    return true;
+}
+
+/* Returns the next unread character without consuming it, or -1 at EOF. */
+static inline int peek(trace_reader_t *trace) {
+    if (trace->pos == trace->len && !refill(trace))
+        return -1;
+    return (unsigned char)trace->buf[trace->pos];
+}
+
+/**
+ * Function: read_int
+ * ------------------
+ * Parses the next whitespace separated decimal integer.
+ *
+ * Returns:
+ *  true if an integer was read; false at the end of the file, or on a
+ *  malformed token or one outside the range of an int, in which case
+ *  trace->error is set.
+ */
+static bool read_int(trace_reader_t *trace, int *out) {
+    int c;
+    bool negative = false;
+    long value = 0;
+
+    while ((c = peek(trace)) == ' ' || c == '\n' || c == '\t' || c == '\r')
+        trace->pos++;
+    if (c == -1)
+        return false;
+
+    if (c == '-' || c == '+') {
+        negative = (c == '-');
+        trace->pos++;
+        c = peek(trace);
+    }
+    if (c < '0' || c > '9') {
+        trace->error = true;
+        return false;
+    }
+
+    while ((c = peek(trace)) >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        if (value > (long)INT_MAX + negative) {  // does not fit an int
+            trace->error = true;
+            return false;
+        }
+        trace->pos++;
+    }
+
+    *out = (int)(negative ? -value : value);
+    return true;
+}
+
+static uint32_t get_le32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_le32(unsigned char *p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+/**
+ * Function: open_binary
+ * ---------------------
+ * Maps a binary trace and validates its header.
+ *
+ * Returns:
+ *  true if the file is a binary trace (trace->error is set if it is a broken
+ *  one); false if it is not, in which case it is read as text.
+ */
+static bool open_binary(trace_reader_t *trace) {
+    struct stat st;
+    unsigned char header[TRACE_BIN_HEADER_SIZE];
+
+    if (fstat(trace->fd, &st) != 0 || st.st_size < TRACE_BIN_HEADER_SIZE)
+        return false;
+    if (pread(trace->fd, header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header, TRACE_BIN_MAGIC, 4) != 0)
+        return false;
+
+    trace->partition_size = (int32_t)get_le32(header + 8);
+    trace->op_count = get_le32(header + 16) | (uint64_t)get_le32(header + 20) << 32;
+
+    uint32_t version = get_le32(header + 4);
+    trace->record_size = get_le32(header + 12);
+
+    if (!((version == TRACE_BIN_VERSION && trace->record_size == TRACE_BIN_RECORD_SIZE) ||
+          (version == 1 && trace->record_size == TRACE_BIN_V1_RECORD_SIZE)) ||
+        (uint64_t)(st.st_size - TRACE_BIN_HEADER_SIZE) / trace->record_size < trace->op_count) {
+        fprintf(stderr, "Error: unsupported or truncated binary trace\n");
+        trace->error = true;
+        return true;
+    }
+
+    trace->map_size = st.st_size;
+    trace->map = mmap(NULL, trace->map_size, PROT_READ, MAP_PRIVATE, trace->fd, 0);
+    if (trace->map == MAP_FAILED) {
+        fprintf(stderr, "Error reading file\n");
+        trace->map = NULL;
+        trace->error = true;
+        return true;
+    }
+    madvise((void *)trace->map, trace->map_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+trace_reader_t *trace_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    trace_reader_t *trace = malloc(sizeof(trace_reader_t));
+    if (trace == NULL) {
+        fprintf(stderr, "Error: trace_open failed\n");
+        exit(EXIT_FAILURE);
+    }
+    trace->fd = fd;
+    trace->buf = NULL;
+    trace->len = trace->pos = 0;
+    trace->eof = false;
+    trace->error = false;
+    trace->partition_size = 0;
+    trace->map = NULL;
+    trace->map_size = 0;
+    trace->op_count = trace->next_op = 0;
+    trace->record_size = 0;
+
+    if (open_binary(trace)) {
+        if (!trace->error)
+            printf("PARTITION_SIZE = %d\n", trace->partition_size);
+        return trace;
+    }
+
+    // Only a text trace is read through the buffer
+    if ((trace->buf = malloc(TRACE_BUFFER_SIZE)) == NULL) {
+        fprintf(stderr, "Error: trace_open failed\n");
+        exit(EXIT_FAILURE);
     }
 
     // Get the initial partition size
-    if (fscanf(f, "%d\n", PARTITION_SIZE) != 1) {
+    if (!read_int(trace, &trace->partition_size)) {
         fprintf(stderr, "Error reading partition size\n");
-        return;
-    }
-    printf("PARTITION_SIZE = %d\n", *PARTITION_SIZE);
-
-    // Read the rest of the file
-    while (1) {
-        int read = fscanf(f, "%d %d\n", &input[*n][0], &input[*n][1]);
-        if (read != 2) {
-            if (feof(f)) {
-                // Reached the end of the file
-                break;
-            } else {
-                // Read error occurred
-                fprintf(stderr, "Error reading file\n");
-                break;
-            }
-        }
-        *n += 1;
+        trace->error = true;
+        return trace;
+    }
+    printf("PARTITION_SIZE = %d\n", trace->partition_size);
+
+    return trace;
+}
+
+/* Returns whether a text trace operation starting with this word has a third. */
+static bool has_two_operands(int opcode) {
+    return opcode == TRACE_OP_RESIZE || opcode == TRACE_OP_FREE_AT || opcode == TRACE_OP_QUERY ||
+           opcode == TRACE_OP_ACCESS;
+}
+
+bool trace_next(trace_reader_t *trace, int op[TRACE_OP_WORDS]) {
+    if (trace->error)
+        return false;
+
+    if (trace->map != NULL) {
+        if (trace->next_op == trace->op_count)
+            return false;
+        const unsigned char *rec = trace->map + TRACE_BIN_HEADER_SIZE +
+                                   trace->next_op++ * trace->record_size;
+        op[0] = (int32_t)get_le32(rec);
+        op[1] = (int32_t)get_le32(rec + 4);
+        op[2] = trace->record_size == TRACE_BIN_RECORD_SIZE ? (int32_t)get_le32(rec + 8) : 0;
+        return true;
+    }
+
+    op[2] = 0;
+    if (!read_int(trace, &op[0]) || !read_int(trace, &op[1]) ||
+        (has_two_operands(op[0]) && !read_int(trace, &op[2]))) {
+        if (trace->error)
+            fprintf(stderr, "Error reading file\n"); // Read error occurred
+        return false;
     }
-}
\ No newline at end of file
+    return true;
+}
+
+void trace_close(trace_reader_t *trace) {
+    if (trace != NULL) {
+        if (trace->map != NULL)
+            munmap((void *)trace->map, trace->map_size);
+        close(trace->fd);
+        free(trace->buf);
+        free(trace);
+    }
+}
+
+/**
+ * Function: trace_convert
+ * -----------------------
+ * Converts a text trace into the binary trace format.
+ *
+ * Description:
+ *  The text trace is streamed through trace_next and each operation written
+ *  as one record; the header is rewritten with the final count at the end.
+ *  Every write is checked, fclose included as it flushes the buffer. Until
+ *  the header is rewritten the file has no magic, so a conversion that
+ *  fails part way leaves a file that is never taken for a binary trace.
+ */
+long trace_convert(const char *text_path, const char *bin_path) {
+    unsigned char header[TRACE_BIN_HEADER_SIZE] = {0};
+    unsigned char rec[TRACE_BIN_RECORD_SIZE];
+    uint64_t count = 0;
+    int op[TRACE_OP_WORDS];
+    bool written;
+
+    trace_reader_t *trace = trace_open(text_path);
+    if (trace == NULL)
+        return -1;
+
+    FILE *out = fopen(bin_path, "wb");
+    if (out == NULL) {
+        trace_close(trace);
+        return -1;
+    }
+    setvbuf(out, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+
+    written = fwrite(header, 1, sizeof(header), out) == sizeof(header); // placeholder until the count is known
+    while (written && trace_next(trace, op)) {
+        put_le32(rec, (uint32_t)op[0]);
+        put_le32(rec + 4, (uint32_t)op[1]);
+        put_le32(rec + 8, (uint32_t)op[2]);
+        written = fwrite(rec, 1, sizeof(rec), out) == sizeof(rec);
+        count++;
+    }
+
+    if (written && !trace->error) {
+        memcpy(header, TRACE_BIN_MAGIC, 4);
+        put_le32(header + 4, TRACE_BIN_VERSION);
+        put_le32(header + 8, (uint32_t)trace->partition_size);
+        put_le32(header + 12, TRACE_BIN_RECORD_SIZE);
+        put_le32(header + 16, (uint32_t)count);
+        put_le32(header + 20, (uint32_t)(count >> 32));
+        written = fseek(out, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    }
+    if (fclose(out) != 0)
+        written = false;
+
+    if (!written)
+        fprintf(stderr, "Error: writing %s failed: %s\n", bin_path, strerror(errno));
+    else if (trace->error)
+        fprintf(stderr, "Error: %s is not a valid trace\n", text_path);
+
+    bool failed = !written || trace->error;
+    trace_close(trace);
+    return failed ? -2 : (long)count;
+}